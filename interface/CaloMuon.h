@@ -8,6 +8,12 @@
  *  - calorimeter energy deposition
  *  - calo compatibility variable
  *
+ * The momentum and charge of the track are copied into the CaloMuon by
+ * setInnerTrack(), so that the kinematic accessors do not go through
+ * the track reference. CaloMuons read from files written before that
+ * fall back to the track until refreshKinematics() is called, e.g. for
+ * a whole collection with muon::refreshKinematics().
+ *
  * \author Dmytro Kovalskyi, UCSB
  *
  * \version $Id: CaloMuon.h,v 1.3 2008/04/30 22:58:14 dmytro Exp $
@@ -16,6 +22,8 @@
 #include "DataFormats/MuonReco/interface/MuonEnergy.h"
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
 #include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/Math/interface/Vector3D.h"
+#include <vector>
 
 namespace reco {
  
@@ -28,12 +36,12 @@ namespace reco {
     virtual TrackRef innerTrack() const { return innerTrack_; }
     virtual TrackRef track() const { return innerTrack(); }
     /// set reference to Track
-    virtual void setInnerTrack( const TrackRef & t ) { innerTrack_ = t; }
+    virtual void setInnerTrack( const TrackRef & t );
     virtual void setTrack( const TrackRef & t ) { setInnerTrack(t); }
     /// energy deposition
     bool isEnergyValid() const { return energyValid_; }
     /// get energy deposition information
-    MuonEnergy calEnergy() const { return calEnergy_; }
+    const MuonEnergy& calEnergy() const { return calEnergy_; }
     /// set energy deposition information
     void setCalEnergy( const MuonEnergy& calEnergy ) { calEnergy_ = calEnergy; energyValid_ = true; }
      
@@ -45,23 +53,34 @@ namespace reco {
     bool  isCaloCompatibilityValid() const { return caloCompatibility_>=0; } 
      
     /// a bunch of useful accessors
-    int charge() const { return innerTrack_.get()->charge(); }
+    int charge() const { return isKinematicsCached() ? charge_ : innerTrack_.get()->charge(); }
+    /// momentum vector of the track
+    math::XYZVector momentum() const { return isKinematicsCached() ? momentum_ : innerTrack_.get()->momentum(); }
     /// polar angle  
-    double theta() const { return innerTrack_.get()->theta(); }
+    double theta() const { return momentum().Theta(); }
     /// momentum vector magnitude
-    double p() const { return innerTrack_.get()->p(); }
+    double p() const { return momentum().R(); }
     /// track transverse momentum
-    double pt() const { return innerTrack_.get()->pt(); }
+    double pt() const { return momentum().Rho(); }
     /// x coordinate of momentum vector
-    double px() const { return innerTrack_.get()->px(); }
+    double px() const { return momentum().X(); }
     /// y coordinate of momentum vector
-    double py() const { return innerTrack_.get()->py(); }
+    double py() const { return momentum().Y(); }
     /// z coordinate of momentum vector
-    double pz() const { return innerTrack_.get()->pz(); }
+    double pz() const { return momentum().Z(); }
     /// azimuthal angle of momentum vector
-    double phi() const { return innerTrack_.get()->phi(); }
+    double phi() const { return momentum().Phi(); }
     /// pseudorapidity of momentum vector
-    double eta() const { return innerTrack_.get()->eta(); }
+    double eta() const { return momentum().Eta(); }
+
+    /// whether the kinematics are held by the CaloMuon itself; a track
+    /// always has a charge, so a charge of 0 means they are not
+    bool isKinematicsCached() const { return charge_ != 0; }
+    /// copy the momentum and charge of the track again
+    void refreshKinematics() { setKinematics(innerTrack_.isNonnull() && innerTrack_.isAvailable() ? innerTrack_.get() : 0); }
+    /// copy the momentum and charge of a track, which must be the inner
+    /// track; a null track clears them
+    void setKinematics( const Track* track );
      
   private:
     /// reference to Track reconstructed in the tracker only
@@ -71,9 +90,18 @@ namespace reco {
     bool energyValid_;
     /// muon hypothesis compatibility with observer calorimeter energy
     float caloCompatibility_;
+    /// momentum and charge of the inner track
+    math::XYZVector momentum_;
+    int charge_;
   };
 
 }
 
+namespace muon {
+  /// refresh the kinematics of all the CaloMuons of a collection, looking
+  /// up the track collection only once for all the ones referring to it
+  void refreshKinematics( std::vector<reco::CaloMuon>& muons );
+}
+
 
 #endif
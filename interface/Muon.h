@@ -15,6 +15,9 @@
  */
 #include "DataFormats/RecoCandidate/interface/RecoCandidate.h"
 #include "DataFormats/MuonReco/interface/MuonChamberMatch.h"
+#include "DataFormats/MuonReco/interface/MuonMatchBlock.h"
+#include "DataFormats/MuonReco/interface/MuonTruthMatch.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
 #include "DataFormats/MuonReco/interface/MuonIsolation.h"
 #include "DataFormats/MuonReco/interface/MuonPFIsolation.h"
 #include "DataFormats/MuonReco/interface/MuonEnergy.h"
@@ -22,6 +25,7 @@
 #include "DataFormats/MuonReco/interface/MuonQuality.h"
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
 #include "DataFormats/TrackReco/interface/Track.h"
+#include "FWCore/Utilities/interface/AtomicPtrCache.h"
 
 namespace reco {
  
@@ -100,7 +104,7 @@ namespace reco {
     /// ====================== PF BLOCK ===========================
     ///
 
-    reco::Candidate::LorentzVector  pfP4() const  {return pfP4_;}
+    const reco::Candidate::LorentzVector& pfP4() const  {return pfP4_;}
     virtual void setPFP4( const reco::Candidate::LorentzVector& p4_ ); 
 
     ///
@@ -109,7 +113,7 @@ namespace reco {
     /// energy deposition
     bool isEnergyValid() const { return energyValid_; }
     /// get energy deposition information
-    MuonEnergy calEnergy() const { return calEnergy_; }
+    const MuonEnergy& calEnergy() const { return calEnergy_; }
     /// set energy deposition information
     void setCalEnergy( const MuonEnergy& calEnergy ) { calEnergy_ = calEnergy; energyValid_ = true; }
     
@@ -119,7 +123,7 @@ namespace reco {
     /// energy deposition
     bool isQualityValid() const { return qualityValid_; }
     /// get energy deposition information
-    MuonQuality combinedQuality() const { return combinedQuality_; }
+    const MuonQuality& combinedQuality() const { return combinedQuality_; }
     /// set energy deposition information
     void setCombinedQuality( const MuonQuality& combinedQuality ) { combinedQuality_ = combinedQuality; qualityValid_ = true; }
 
@@ -129,7 +133,7 @@ namespace reco {
     /// timing information
     bool isTimeValid() const { return (time_.nDof>0); }
     /// get timing information
-    MuonTime time() const { return time_; }
+    const MuonTime& time() const { return time_; }
     /// set timing information
     void setTime( const MuonTime& time ) { time_ = time; }
      
@@ -138,10 +142,32 @@ namespace reco {
     ///
     bool isMatchesValid() const { return matchesValid_; }
     /// get muon matching information
-    std::vector<MuonChamberMatch>& matches() { return muMatches_;}
-    const std::vector<MuonChamberMatch>& matches() const { return muMatches_;	}
+    std::vector<MuonChamberMatch>& matches() { unpackMatches(); return muMatches_;}
+    const std::vector<MuonChamberMatch>& matches() const { return matchBlock_.empty() ? muMatches_ : unpackedMatches(); }
     /// set muon matching information
-    void setMatches( const std::vector<MuonChamberMatch>& matches ) { muMatches_ = matches; matchesValid_ = true; }
+    void setMatches( const std::vector<MuonChamberMatch>& matches ) { muMatches_ = matches; matchBlock_.clear(); unpackedMatches_.reset(); legacyTruthMatches_.reset(); matchesValid_ = true; }
+    /// store the matching information in the compact buffer of
+    /// MuonMatchBlock when the muon is written out, by default with full
+    /// precision (see MuonReducedPrecision.h). Muons read back packed
+    /// keep the buffer undecoded until matches() or one of the station
+    /// accessors is called; the const accessors unpack once into a
+    /// transient cache and are safe to call concurrently. The non-const
+    /// matches() copies that cache, so references returned before stay
+    /// valid until the matches are set or packed again.
+    void packMatches( const muon::MuonMatchPrecision& precision = muon::MuonMatchPrecision() );
+    bool isMatchesPacked() const { return !matchBlock_.empty(); }
+    const MuonMatchBlock& matchBlock() const { return matchBlock_; }
+    /// Monte Carlo truth matches, one entry per chamber, looked up in the
+    /// truth map by self, the reference to this muon. Muons read from files
+    /// written before the truth map existed fall back to the truth matches
+    /// stored in their chamber matches; empty on data.
+    const MuonTruthMatches& truthMatches( const MuonTruthMatchMap& truth, const MuonRef& self ) const;
+    /// truth matches in one chamber, 0 if there are none
+    const std::vector<MuonSegmentMatch>* truthMatches( const MuonTruthMatchMap& truth, const MuonRef& self,
+                                                       const DetId& chamber ) const;
+    /// truth matches read from files written before the truth map, collected
+    /// from MuonChamberMatch::legacyTruthMatches on first call
+    const MuonTruthMatches& legacyTruthMatches() const;
      
     ///
     /// ====================== MUON COMPATIBILITY BLOCK ===========================
@@ -159,17 +185,48 @@ namespace reco {
     const MuonIsolation& isolationR03() const { return isolationR03_; }
     const MuonIsolation& isolationR05() const { return isolationR05_; }
 
-    const MuonPFIsolation& pfIsolationR03() const { return pfIsolationR03_; }
-    const MuonPFIsolation& pfMeanDRIsoProfileR03() const { return pfIsoMeanDRR03_; }
-    const MuonPFIsolation& pfSumDRIsoProfileR03() const { return pfIsoSumDRR03_; }
-    const MuonPFIsolation& pfIsolationR04() const { return pfIsolationR04_; }
-    const MuonPFIsolation& pfMeanDRIsoProfileR04() const { return pfIsoMeanDRR04_; }
-    const MuonPFIsolation& pfSumDRIsoProfileR04() const { return pfIsoSumDRR04_; }
+    /// PF isolation types, in storage order: the cone sums first, then
+    /// the mean-DR and sum-DR profiles, which may be left out
+    enum PFIsolationType { PFIsolationR03, PFIsolationR04,
+			   PFIsoMeanDRProfileR03, PFIsoMeanDRProfileR04,
+			   PFIsoSumDRProfileR03, PFIsoSumDRProfileR04,
+			   nPFIsolationTypes };
+#ifndef __GCCXML__
+    /// type of the PF isolation with the given label, nPFIsolationTypes if unknown
+    static constexpr PFIsolationType pfIsolationType( const char* label ) {
+      return
+	sameLabel(label, "pfIsolationR03")        ? PFIsolationR03 :
+	sameLabel(label, "pfIsolationR04")        ? PFIsolationR04 :
+	sameLabel(label, "pfIsoMeanDRProfileR03") ? PFIsoMeanDRProfileR03 :
+	sameLabel(label, "pfIsoMeanDRProfileR04") ? PFIsoMeanDRProfileR04 :
+	sameLabel(label, "pfIsoSumDRProfileR03")  ? PFIsoSumDRProfileR03 :
+	sameLabel(label, "pfIsoSumDRProfileR04")  ? PFIsoSumDRProfileR04 :
+	nPFIsolationTypes;
+    }
+#endif
+
+    /// PF isolation of the given type; empty if it was not stored
+    const MuonPFIsolation& pfIsolation( PFIsolationType type ) const;
+    const MuonPFIsolation& pfIsolationR03() const { return pfIsolation(PFIsolationR03); }
+    const MuonPFIsolation& pfMeanDRIsoProfileR03() const { return pfIsolation(PFIsoMeanDRProfileR03); }
+    const MuonPFIsolation& pfSumDRIsoProfileR03() const { return pfIsolation(PFIsoSumDRProfileR03); }
+    const MuonPFIsolation& pfIsolationR04() const { return pfIsolation(PFIsolationR04); }
+    const MuonPFIsolation& pfMeanDRIsoProfileR04() const { return pfIsolation(PFIsoMeanDRProfileR04); }
+    const MuonPFIsolation& pfSumDRIsoProfileR04() const { return pfIsolation(PFIsoSumDRProfileR04); }
+    /// number of stored PF isolation types; 2 if the profiles were left out
+    unsigned int numberOfPFIsolations() const { return pfIsolations_.size(); }
 
 
     void setIsolation( const MuonIsolation& isoR03, const MuonIsolation& isoR05 );
     bool isIsolationValid() const { return isolationValid_; }
+    /// set the PF isolation with the given label; unknown labels set no
+    /// deposit but, as before, still flag the PF isolation valid
     void setPFIsolation(const std::string& label,const reco::MuonPFIsolation& deposit);
+    void setPFIsolation(PFIsolationType type, const reco::MuonPFIsolation& deposit);
+    /// set the first n PF isolation types from an array in PFIsolationType
+    /// order; n = 2 stores the cone sums only and drops the profiles, n
+    /// beyond nPFIsolationTypes is clamped to it
+    void setPFIsolations(const reco::MuonPFIsolation* deposits, unsigned int n = nPFIsolationTypes);
 
 
     bool isPFIsolationValid() const { return pfIsolationValid_; }
@@ -182,7 +239,7 @@ namespace reco {
     /// ====================== USEFUL METHODs ===========================
     ///
     /// number of chambers (MuonChamberMatches include RPC rolls)
-    int numberOfChambers() const { return muMatches_.size(); }
+    int numberOfChambers() const { return matchBlock_.empty() ? muMatches_.size() : matchBlock_.size(); }
     /// number of chambers not including RPC matches (MuonChamberMatches include RPC rolls)
     int numberOfChambersNoRPC() const;
     /// get number of chambers with matched segments
@@ -243,8 +300,14 @@ namespace reco {
     MuonEnergy calEnergy_;
     /// quality block
     MuonQuality combinedQuality_;
-    /// Information on matching between tracks and segments
+    /// Information on matching between tracks and segments, either
+    /// unpacked in muMatches_ or packed in matchBlock_
     std::vector<MuonChamberMatch> muMatches_;
+    MuonMatchBlock matchBlock_;
+    /// transient: matchBlock_ unpacked on first const access
+    edm::AtomicPtrCache<std::vector<MuonChamberMatch> > unpackedMatches_;
+    /// transient: truth matches of old files, collected on first access
+    edm::AtomicPtrCache<MuonTruthMatches> legacyTruthMatches_;
     /// timing
     MuonTime time_;
     bool energyValid_;
@@ -258,13 +321,9 @@ namespace reco {
     MuonIsolation isolationR03_;
     MuonIsolation isolationR05_;
 
-    /// PF Isolation information for two cones with dR=0.3 and dR=0.4
-    MuonPFIsolation pfIsolationR03_;
-    MuonPFIsolation pfIsoMeanDRR03_;
-    MuonPFIsolation pfIsoSumDRR03_;
-    MuonPFIsolation pfIsolationR04_;
-    MuonPFIsolation pfIsoMeanDRR04_;
-    MuonPFIsolation pfIsoSumDRR04_;
+    /// PF Isolation information for two cones with dR=0.3 and dR=0.4,
+    /// indexed by PFIsolationType
+    std::vector<MuonPFIsolation> pfIsolations_;
 
     /// muon type mask
     unsigned int type_;
@@ -274,6 +333,18 @@ namespace reco {
 
     // FixMe: Still missing trigger information
 
+    /// move the packed matches back into muMatches_
+    void unpackMatches() { if (!matchBlock_.empty()) doUnpackMatches(); }
+    void doUnpackMatches();
+    /// the packed matches, unpacked into unpackedMatches_ by the first caller
+    const std::vector<MuonChamberMatch>& unpackedMatches() const;
+
+#ifndef __GCCXML__
+    static constexpr bool sameLabel( const char* a, const char* b ) {
+      return *a == *b && ( *a == '\0' || sameLabel(a+1, b+1) );
+    }
+#endif
+
     /// get vector of muon chambers for given station and detector
     const std::vector<const MuonChamberMatch*> chambers( int station, int muonSubdetId ) const;
     /// get pointers to best segment and corresponding chamber in vector of chambers
@@ -322,8 +393,8 @@ namespace reco {
      
      float t0(int n=0) {
 	int i = 0;
-	for( std::vector<MuonChamberMatch>::const_iterator chamber = muMatches_.begin();
-	     chamber != muMatches_.end(); ++chamber )
+	for( std::vector<MuonChamberMatch>::const_iterator chamber = matches().begin();
+	     chamber != matches().end(); ++chamber )
 	  for ( std::vector<reco::MuonSegmentMatch>::const_iterator segment = chamber->segmentMatches.begin();
 		segment != chamber->segmentMatches.end(); ++segment )
 	    {
@@ -336,5 +407,13 @@ namespace reco {
 
 }
 
+namespace muon {
+  /// set the PF isolation of a whole collection from an array holding n
+  /// types per muon, in PFIsolationType order: deposits[iMuon*n + type];
+  /// types beyond nPFIsolationTypes are skipped
+  void setPFIsolations( std::vector<reco::Muon>& muons, const reco::MuonPFIsolation* deposits,
+			unsigned int n = reco::Muon::nPFIsolationTypes );
+}
+
 
 #endif
@@ -0,0 +1,128 @@
+#ifndef MuonReco_MuonAttachments_h
+#define MuonReco_MuonAttachments_h
+
+/** \class reco::MuonAttachments
+ *
+ *  The per-muon blocks otherwise stored as separate ValueMaps
+ *  (MuonQuality, MuonCosmicCompatibility, MuonShower,
+ *  MuonMETCorrectionData and the combined, DT and CSC timing)
+ *  gathered in a single product for one muon collection. Each block
+ *  present is one array indexed directly by the muon key, so that all
+ *  the blocks of a muon are reached with one index and no search over
+ *  product ids.
+ *
+ *  muon::fillMuonAttachments builds the product in a single pass from
+ *  the existing ValueMaps. The timing is held as reco::MuonTime, the
+ *  MuonTimeExtra maps of old files being converted.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonQuality.h"
+#include "DataFormats/MuonReco/interface/MuonCosmicCompatibility.h"
+#include "DataFormats/MuonReco/interface/MuonMETCorrectionData.h"
+#include "DataFormats/MuonReco/interface/MuonTime.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include <vector>
+#include "DataFormats/MuonReco/interface/MuonShower.h"
+
+namespace reco {
+   class MuonAttachments {
+      public:
+	 enum Block { Quality             = 1<<0,
+		      CosmicCompatibility = 1<<1,
+		      Shower              = 1<<2,
+		      METCorrection       = 1<<3,
+		      TimeCombined        = 1<<4,
+		      TimeDT              = 1<<5,
+		      TimeCSC             = 1<<6 };
+
+	 MuonAttachments():blocks_(0),size_(0) {}
+	 /// empty blocks of the given Block mask for every muon of the collection
+	 MuonAttachments( const MuonRefProd& muons, unsigned int blocks );
+
+	 bool has( Block block ) const { return (blocks_ & block) != 0; }
+	 unsigned int blocks() const { return blocks_; }
+	 /// number of muons
+	 unsigned int size() const { return size_; }
+	 const MuonRefProd& muons() const { return muons_; }
+
+	 /// index of the muon in the blocks, i.e. its key; throws if the
+	 /// muon is not from the collection of the attachments
+	 unsigned int index( const MuonRef& muon ) const;
+
+	 // The accessors by index do not check that the block is present.
+	 const MuonQuality&             quality( unsigned int i )             const { return quality_[i]; }
+	 const MuonCosmicCompatibility& cosmicCompatibility( unsigned int i ) const { return cosmicCompatibility_[i]; }
+	 const MuonShower&              shower( unsigned int i )              const { return shower_[i]; }
+	 const MuonMETCorrectionData&   metCorrection( unsigned int i )       const { return metCorrection_[i]; }
+	 const MuonTime&                timeCombined( unsigned int i )        const { return timeCombined_[i]; }
+	 const MuonTime&                timeDT( unsigned int i )              const { return timeDT_[i]; }
+	 const MuonTime&                timeCSC( unsigned int i )             const { return timeCSC_[i]; }
+
+	 const MuonQuality&             quality( const MuonRef& muon )             const { return quality_[index(muon)]; }
+	 const MuonCosmicCompatibility& cosmicCompatibility( const MuonRef& muon ) const { return cosmicCompatibility_[index(muon)]; }
+	 const MuonShower&              shower( const MuonRef& muon )              const { return shower_[index(muon)]; }
+	 const MuonMETCorrectionData&   metCorrection( const MuonRef& muon )       const { return metCorrection_[index(muon)]; }
+	 const MuonTime&                timeCombined( const MuonRef& muon )        const { return timeCombined_[index(muon)]; }
+	 const MuonTime&                timeDT( const MuonRef& muon )              const { return timeDT_[index(muon)]; }
+	 const MuonTime&                timeCSC( const MuonRef& muon )             const { return timeCSC_[index(muon)]; }
+
+	 /// whole blocks, empty if not present
+	 const std::vector<MuonQuality>&             qualities()             const { return quality_; }
+	 const std::vector<MuonCosmicCompatibility>& cosmicCompatibilities() const { return cosmicCompatibility_; }
+	 const std::vector<MuonShower>&              showers()               const { return shower_; }
+	 const std::vector<MuonMETCorrectionData>&   metCorrections()        const { return metCorrection_; }
+	 const std::vector<MuonTime>&                timesCombined()         const { return timeCombined_; }
+	 const std::vector<MuonTime>&                timesDT()               const { return timeDT_; }
+	 const std::vector<MuonTime>&                timesCSC()              const { return timeCSC_; }
+
+	 // The setters require the block to be present.
+	 void setQuality( unsigned int i, const MuonQuality& quality ) { quality_[i] = quality; }
+	 void setCosmicCompatibility( unsigned int i, const MuonCosmicCompatibility& compatibility ) { cosmicCompatibility_[i] = compatibility; }
+	 void setShower( unsigned int i, const MuonShower& shower ) { shower_[i] = shower; }
+	 void setMETCorrection( unsigned int i, const MuonMETCorrectionData& correction ) { metCorrection_[i] = correction; }
+	 void setTimeCombined( unsigned int i, const MuonTime& time ) { timeCombined_[i] = time; }
+	 void setTimeDT( unsigned int i, const MuonTime& time ) { timeDT_[i] = time; }
+	 void setTimeCSC( unsigned int i, const MuonTime& time ) { timeCSC_[i] = time; }
+
+	 void swap( MuonAttachments& other );
+
+      private:
+	 MuonRefProd muons_;
+	 unsigned int blocks_;
+	 unsigned int size_;
+	 std::vector<MuonQuality>             quality_;
+	 std::vector<MuonCosmicCompatibility> cosmicCompatibility_;
+	 std::vector<MuonShower>              shower_;
+	 std::vector<MuonMETCorrectionData>   metCorrection_;
+	 std::vector<MuonTime>                timeCombined_;
+	 std::vector<MuonTime>                timeDT_;
+	 std::vector<MuonTime>                timeCSC_;
+   };
+}
+
+namespace muon {
+   /// the ValueMaps to gather in a reco::MuonAttachments; null maps are
+   /// left out. The MuonTimeExtra maps are only found in old files.
+   struct MuonAttachmentSources {
+      const edm::ValueMap<reco::MuonQuality>*             quality;
+      const edm::ValueMap<reco::MuonCosmicCompatibility>* cosmicCompatibility;
+      const edm::ValueMap<reco::MuonShower>*              shower;
+      const edm::ValueMap<reco::MuonMETCorrectionData>*   metCorrection;
+      const edm::ValueMap<reco::MuonTimeExtra>*           timeExtraCombined;
+      const edm::ValueMap<reco::MuonTimeExtra>*           timeExtraDT;
+      const edm::ValueMap<reco::MuonTimeExtra>*           timeExtraCSC;
+
+      MuonAttachmentSources():quality(0),cosmicCompatibility(0),shower(0),metCorrection(0),
+	 timeExtraCombined(0),timeExtraDT(0),timeExtraCSC(0) {}
+   };
+
+   /// fill all the blocks of the given sources for every muon of the
+   /// collection in one pass; throws if a source has no entry for it
+   void fillMuonAttachments( const reco::MuonRefProd& muons, const MuonAttachmentSources& sources,
+			     reco::MuonAttachments& attachments );
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef MuonReco_MuonCaloCompatibility_h
+#define MuonReco_MuonCaloCompatibility_h
+
+/** \class muon::CaloCompatibilityTemplates
+ *
+ *  Calorimeter compatibility of a track with the muon hypothesis,
+ *  evaluated from the MuonEnergy deposits, so that caloCompatibility()
+ *  can be recomputed with new templates without rerunning the
+ *  reconstruction.
+ *
+ *  For each pseudorapidity region, the templates are binned
+ *  probabilities of the ECAL, HCAL and HO energy as a function of the
+ *  track momentum, for muons and for pions. The compatibility is
+ *  L_muon/(L_muon+L_pion), the likelihoods being the products of the
+ *  three probabilities. The energies are the ones crossed by the track
+ *  (em, had, ho) or their 3x3 sums (emS9, hadS9, hoS9).
+ *
+ *  All the bins are kept in one array, the muon and pion values of a
+ *  bin next to each other, so that a lookup reads a single place. The
+ *  batch evaluation works on blocks of tracks: the bins are found and
+ *  the ratios computed over flat arrays, which the compiler vectorizes,
+ *  only the template reads being done one by one.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonEnergy.h"
+#include <vector>
+
+namespace reco {
+   class CaloMuon;
+}
+
+namespace muon {
+
+   class CaloCompatibilityTemplates {
+   public:
+      enum Hypothesis { MuonHypothesis, PionHypothesis, nHypotheses };
+      enum Variable { EM, Had, HO, nVariables };
+
+      /// regions between consecutive etaEdges, tracks outside of them
+      /// going to the first or last region; nP momentum bins in
+      /// [pMin, pMax) and nEnergy energy bins in [0, energyMax[v]) for
+      /// each variable, the values outside being taken from the edge bins.
+      /// A NaN momentum, pseudorapidity or energy takes the first bin.
+      CaloCompatibilityTemplates( const std::vector<float>& etaEdges,
+				  unsigned int nP, float pMin, float pMax,
+				  unsigned int nEnergy, const float energyMax[nVariables],
+				  bool useS9 = false );
+
+      /// nP*nEnergy probabilities, momentum major
+      void setTemplate( Hypothesis hypothesis, Variable variable, unsigned int region, const float* values );
+      /// floor of the probabilities when evaluated, so that an empty bin
+      /// does not decide alone; 0 by default
+      void setMinimumProbability( float probability ) { minimumProbability_ = probability; }
+
+      unsigned int numberOfRegions() const { return etaEdges_.size()-1; }
+      unsigned int region( float eta ) const;
+      float energy( const reco::MuonEnergy& energy, Variable variable ) const;
+
+      /// probability of one variable for one hypothesis
+      float probability( Hypothesis hypothesis, Variable variable, float p, float eta, float energy ) const;
+      /// L_muon/(L_muon+L_pion), 0.5 if both likelihoods vanish
+      float compatibility( float p, float eta, const reco::MuonEnergy& energy ) const;
+      float compatibility( float p, float eta, const float energies[nVariables] ) const;
+
+      /// n tracks from flat arrays; energies[v] points to the n values of variable v
+      void compatibilities( const float* p, const float* eta, const float* const energies[nVariables],
+			    unsigned int n, float* result ) const;
+
+   private:
+      unsigned int pBin( float p ) const;
+      unsigned int energyBin( Variable variable, float energy ) const;
+      unsigned int index( unsigned int region, Variable variable, unsigned int pBin, unsigned int energyBin ) const {
+	 return (((region*nVariables + variable)*nP_ + pBin)*nEnergy_ + energyBin)*nHypotheses;
+      }
+
+      std::vector<float> etaEdges_;
+      unsigned int nP_;
+      float pMin_, pBinsPerGeV_;
+      unsigned int nEnergy_;
+      float energyBinsPerGeV_[nVariables];
+      bool useS9_;
+      float minimumProbability_;
+      /// probabilities, muon and pion interleaved
+      std::vector<float> values_;
+   };
+
+   /// the compatibility of every muon of a collection, computed with the
+   /// candidate momentum and pseudorapidity; -9999 for the muons without
+   /// valid energy, which is what isCaloCompatibilityValid() rejects
+   void fillCaloCompatibilities( const reco::MuonCollection& muons, const CaloCompatibilityTemplates& templates,
+				 std::vector<float>& compatibilities );
+   void fillCaloCompatibilities( const std::vector<reco::CaloMuon>& muons, const CaloCompatibilityTemplates& templates,
+				 std::vector<float>& compatibilities );
+
+   /// recompute and store the compatibility of every muon of a collection
+   void setCaloCompatibilities( reco::MuonCollection& muons, const CaloCompatibilityTemplates& templates );
+   void setCaloCompatibilities( std::vector<reco::CaloMuon>& muons, const CaloCompatibilityTemplates& templates );
+}
+
+#endif
@@ -5,12 +5,12 @@
 #include "DataFormats/MuonReco/interface/MuonSegmentMatch.h"
 #include "DataFormats/MuonReco/interface/MuonRPCHitMatch.h"
 #include <vector>
+#include <memory>
 
 namespace reco {
    class MuonChamberMatch {
       public:
          std::vector<reco::MuonSegmentMatch> segmentMatches;    // segments matching propagated track trajectory
-         std::vector<reco::MuonSegmentMatch> truthMatches;      // SimHit projection matching propagated track trajectory
          std::vector<reco::MuonRPCHitMatch>  rpcMatches;        // rpc hits matching propagated track trajectory 
          float edgeX;      // distance to closest edge in X (negative - inside, positive - outside)
          float edgeY;      // distance to closest edge in Y (negative - inside, positive - outside)
@@ -23,6 +23,11 @@ namespace reco {
          float dXdZErr;    // propagation uncertainty in dX/dZ
          float dYdZErr;    // propagation uncertainty in dY/dZ
          DetId id;         // chamber ID
+         /// transient: SimHit projections read from files written before
+         /// version 12, which stored them here; null otherwise. Truth
+         /// matches are now kept in a reco::MuonTruthMatchMap, see
+         /// reco::Muon::truthMatches
+         std::shared_ptr<const std::vector<reco::MuonSegmentMatch> > legacyTruthMatches;
 
          int detector() const { return id.subdetId(); }
          int station()  const;
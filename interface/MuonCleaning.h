@@ -0,0 +1,107 @@
+#ifndef MuonReco_MuonCleaning_h
+#define MuonReco_MuonCleaning_h
+
+/** \class muon::MuonGhostCleaner
+ *
+ *  Duplicate ("ghost") muon removal built on muon::overlap and
+ *  muon::sharedSegments. The pairwise relations are evaluated once
+ *  per collection, and only for pairs of muons that have at least
+ *  one chamber (or, if adjacent chambers are checked, one CSC ring)
+ *  in common, since no other pair can overlap or share a segment.
+ *  The muons are then ranked with a configurable policy and every
+ *  muon related to a better ranked surviving muon is flagged as its
+ *  ghost.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonSegmentMatch.h"
+#include <vector>
+
+namespace muon {
+
+   /// criteria used to decide which of two duplicate muons survives
+   enum GhostRankingCriterion {
+      RankByType = 0,               // more of the preferred type bits wins
+      RankByNumberOfMatches = 1,    // more matched chambers wins
+      RankByPt = 2                  // higher pt wins
+   };
+
+   struct GhostCleaningParameters {
+      /// relations used to flag a pair of muons as duplicates
+      bool   useOverlap;
+      bool   useSharedSegments;
+      /// parameters passed to muon::overlap
+      double pullX;
+      double pullY;
+      bool   checkAdjacentChambers;
+      /// parameters passed to muon::sharedSegments
+      unsigned int segmentArbitrationMask;
+      int    minSharedSegments;
+      /// ranking policy, criteria are applied in order until one decides
+      std::vector<GhostRankingCriterion> ranking;
+      /// muon type bits (reco::Muon::GlobalMuon etc.) preferred by RankByType
+      unsigned int preferredTypes;
+      /// arbitration used to count matches for RankByNumberOfMatches
+      reco::Muon::ArbitrationType arbitrationType;
+
+      GhostCleaningParameters():
+	useOverlap(true), useSharedSegments(true),
+	pullX(1.0), pullY(1.0), checkAdjacentChambers(false),
+	segmentArbitrationMask(reco::MuonSegmentMatch::BestInChamberByDR), minSharedSegments(1),
+	preferredTypes(reco::Muon::GlobalMuon | reco::Muon::TrackerMuon),
+	arbitrationType(reco::Muon::SegmentAndTrackArbitration)
+      {
+	 ranking.push_back(RankByNumberOfMatches);
+	 ranking.push_back(RankByPt);
+      }
+   };
+
+   class MuonGhostCleaner {
+   public:
+      explicit MuonGhostCleaner( const GhostCleaningParameters& parameters = GhostCleaningParameters() );
+
+      /// Clean a collection. On return ghostOf has one entry per muon:
+      /// -1 for surviving muons, otherwise the index of the surviving
+      /// muon it duplicates.
+      void clean( const reco::MuonCollection& muons, std::vector<int>& ghostOf ) const;
+
+      /// Same as above, returning the references to the surviving muons.
+      /// HandleT is anything a reco::MuonRef can be built from
+      /// (edm::Handle, edm::OrphanHandle, edm::RefProd, ...).
+      template<typename HandleT>
+      reco::MuonRefVector clean( const HandleT& muons, std::vector<int>& ghostOf ) const {
+	 clean(*muons, ghostOf);
+	 reco::MuonRefVector cleaned;
+	 for(unsigned int i = 0; i < ghostOf.size(); ++i)
+	    if (ghostOf[i] < 0) cleaned.push_back(reco::MuonRef(muons, i));
+	 return cleaned;
+      }
+
+      /// true if the first muon ranks better than the second one
+      bool isBetter( const reco::Muon& muon1, const reco::Muon& muon2 ) const;
+
+      /// true if the two muons are duplicates according to the configured relations
+      bool areDuplicates( const reco::Muon& muon1, const reco::Muon& muon2 ) const;
+
+      const GhostCleaningParameters& parameters() const { return parameters_; }
+
+   private:
+      struct RankingKey {
+	 unsigned int nPreferredTypes;
+	 int nMatches;
+	 double pt;
+      };
+
+      class RankOrder;
+
+      RankingKey rankingKey( const reco::Muon& muon ) const;
+      bool isBetter( const RankingKey& key1, const RankingKey& key2 ) const;
+
+      GhostCleaningParameters parameters_;
+   };
+
+}
+
+#endif
@@ -12,8 +12,11 @@
  */
 
 #include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonTrackTable.h"
 #include "DataFormats/TrackReco/interface/TrackFwd.h"
 #include "DataFormats/TrackReco/interface/TrackToTrackMap.h"
+#include <vector>
 
 namespace muon {
   
@@ -43,6 +46,131 @@ namespace muon {
 			dptcut);  
   }
 
+  // Collection version: gathers the fit quantities of the tracker,
+  // global, TPFMS and picky fits of all the muons into contiguous
+  // arrays in a single pass, then runs the selection over the arrays.
+  // The decisions are identical to calling the per-muon version on
+  // each muon in turn.
+  void tevOptimized(const reco::MuonCollection& muons,
+		    std::vector<reco::Muon::MuonTrackTypePair>& result,
+		    const double ptThreshold = 200.,
+		    const double tune1 = 17.,
+		    const double tune2 = 40.,
+		    const double dptcut = 0.25);
+
+  // The inputs of the TuneP decision for one muon, extracted once so
+  // that the decision can be re-evaluated for many parameter sets
+  // without going back to the tracks. The fits are in the order
+  // tracker, global, TPFMS, picky (see cocktailTrackType).
+  struct MuonCocktailInputs {
+    char   valid[4];      // the refit is available
+    char   hasHits[4];    // the refit has valid hits
+    double pt[4];
+    double dptOverPt[4];  // ptError/pt
+    double prob[4];       // -ln(tail probability), 0 if no valid hits
+  };
+
+  // The track type of the i-th fit of MuonCocktailInputs.
+  inline reco::Muon::MuonTrackType cocktailTrackType(const int i) {
+    switch (i) {
+    case 0:  return reco::Muon::InnerTrack;
+    case 1:  return reco::Muon::CombinedTrack;
+    case 2:  return reco::Muon::TPFMS;
+    case 3:  return reco::Muon::Picky;
+    default: return reco::Muon::None;
+    }
+  }
+
+  void fillCocktailInputs(const reco::TrackRef& combinedTrack,
+			  const reco::TrackRef& trackerTrack,
+			  const reco::TrackRef& tpfmsTrack,
+			  const reco::TrackRef& pickyTrack,
+			  MuonCocktailInputs& inputs);
+
+  void fillCocktailInputs(const MuonTrackRow& tracks, MuonCocktailInputs& inputs);
+
+  inline void fillCocktailInputs(const reco::Muon& muon, MuonCocktailInputs& inputs) {
+    fillCocktailInputs(muon.globalTrack(),
+		       muon.innerTrack(),
+		       muon.tpfmsTrack(),
+		       muon.pickyTrack(),
+		       inputs);
+  }
+
+  // Collection version, one record per muon; the tail probabilities
+  // are computed in a single batch.
+  void fillCocktailInputs(const reco::MuonCollection& muons,
+			  std::vector<MuonCocktailInputs>& inputs);
+
+  void fillCocktailInputs(const MuonTrackTable& table,
+			  std::vector<MuonCocktailInputs>& inputs);
+
+  // The TuneP decision from precomputed inputs: returns the index of
+  // the chosen fit, identical to the choice made by tevOptimized.
+  int tevOptimizedChoice(const MuonCocktailInputs& inputs,
+			 const double ptThreshold = 200.,
+			 const double tune1 = 17.,
+			 const double tune2 = 40.,
+			 const double dptcut = 0.25);
+
+  // One point of a TuneP parameter scan.
+  struct TunePParameters {
+    double ptThreshold;
+    double tune1;
+    double tune2;
+    double dptcut;
+
+    TunePParameters(const double pt = 200., const double t1 = 17., const double t2 = 40., const double dpt = 0.25):
+      ptThreshold(pt), tune1(t1), tune2(t2), dptcut(dpt) {}
+  };
+
+  // All the combinations of the given values, with dptcut running
+  // fastest and ptThreshold slowest.
+  std::vector<TunePParameters> tunePGrid(const std::vector<double>& ptThresholds,
+					 const std::vector<double>& tune1s,
+					 const std::vector<double>& tune2s,
+					 const std::vector<double>& dptcuts);
+
+  // Evaluate the TuneP decision for every muon at every grid point.
+  // choices[iPoint*inputs.size() + iMuon] is the index of the chosen fit.
+  void tevOptimizedChoices(const std::vector<MuonCocktailInputs>& inputs,
+			   const std::vector<TunePParameters>& grid,
+			   std::vector<unsigned char>& choices);
+
+  // Same, only counting how often each fit is chosen:
+  // counts[4*iPoint + fit] for fit in the order tracker, global, TPFMS, picky.
+  void tevOptimizedChoiceCounts(const std::vector<MuonCocktailInputs>& inputs,
+				const std::vector<TunePParameters>& grid,
+				std::vector<unsigned int>& counts);
+
+  // Same, on an array of nMuons inputs, such as the ones of a
+  // muon::MuonSnapshot.
+  void tevOptimizedChoices(const MuonCocktailInputs* inputs,
+			   const unsigned int nMuons,
+			   const std::vector<TunePParameters>& grid,
+			   std::vector<unsigned char>& choices);
+
+  void tevOptimizedChoiceCounts(const MuonCocktailInputs* inputs,
+				const unsigned int nMuons,
+				const std::vector<TunePParameters>& grid,
+				std::vector<unsigned int>& counts);
+
+  // Versions running on the tracks of a muon::MuonTrackTable: they
+  // return the chosen track type, the track itself being
+  // tracks.track(type).
+  reco::Muon::MuonTrackType tevOptimizedType(const MuonTrackRow& tracks,
+					     const double ptThreshold = 200.,
+					     const double tune1 = 17.,
+					     const double tune2 = 40.,
+					     const double dptcut = 0.25);
+
+  void tevOptimizedTypes(const MuonTrackTable& table,
+			 std::vector<reco::Muon::MuonTrackType>& result,
+			 const double ptThreshold = 200.,
+			 const double tune1 = 17.,
+			 const double tune2 = 40.,
+			 const double dptcut = 0.25);
+
   reco::TrackRef getTevRefitTrack(const reco::TrackRef& combinedTrack,
 				  const reco::TrackToTrackMap& map);
   
@@ -99,13 +227,25 @@ namespace muon {
 			     ptThreshold);
   }
 
+  // Same from the tracks of a muon::MuonTrackTable row; None if the
+  // muon has no global or no tracker track.
+  reco::Muon::MuonTrackType sigmaSwitchType(const MuonTrackRow& tracks,
+					    const double nSigma = 2.,
+					    const double ptThreshold = 200.);
+
   // "Truncated muon reconstructor": the first cocktail, between just
   // tracker-only and TPFMS. Similar to tevOptimized.
   reco::Muon::MuonTrackTypePair TMR(const reco::TrackRef& trackerTrack,
 				    const reco::TrackRef& fmsTrack,
 				    const double tune=4.);
+
+  reco::Muon::MuonTrackType TMRType(const MuonTrackRow& tracks,
+				    const double tune=4.);
   
+  // -ln of the chi2 tail probability of the fit, see MuonTrackProbability.h
   double trackProbability(const reco::TrackRef track);
+  // Same from the fit chi2 and number of degrees of freedom.
+  double trackProbability(const double chi2, const int ndof);
 }
 
 #endif
@@ -0,0 +1,143 @@
+#ifndef MuonReco_MuonMatchBlock_h
+#define MuonReco_MuonMatchBlock_h
+
+/** \class reco::MuonMatchBlock
+ *
+ *  Compact persistent form of the chamber matches of a muon: one opaque
+ *  buffer of 32 bit words holding the chambers, then the segment matches
+ *  of all the chambers, then their RPC hit matches, and the DT and CSC
+ *  segment products the segment matches refer to. ROOT reads the buffer
+ *  as a single array of integers, without building any match object.
+ *
+ *  The buffer is decoded on demand, once, by the first const accessor
+ *  that needs it, into a transient cache of three flat arrays: one of
+ *  chamber records, one of segment matches and one of RPC hit matches,
+ *  each chamber record storing how many entries of the flat arrays
+ *  belong to it. Decoding is thread safe: concurrent callers may all
+ *  decode, only the first result is kept. size() and empty() read the
+ *  buffer header and never decode.
+ *
+ *  The float members can be stored with reduced precision, see
+ *  muon::MuonMatchPrecision in MuonReducedPrecision.h: a float kept with
+ *  b mantissa bits takes 9+b bits of the buffer instead of 32.
+ *
+ *  The chambers can be read in place through ChamberView, which
+ *  allocates nothing beyond the cache. unpack() rebuilds the usual
+ *  std::vector<MuonChamberMatch> straight from the buffer: one
+ *  allocation for the chambers plus one for each non-empty list of
+ *  segment or RPC hit matches, so it is only worth it for code that
+ *  needs the nested vectors.
+ *
+ */
+
+#include "DataFormats/Common/interface/RefCore.h"
+#include "DataFormats/MuonReco/interface/MuonChamberMatch.h"
+#include "DataFormats/MuonReco/interface/MuonReducedPrecision.h"
+#include "FWCore/Utilities/interface/AtomicPtrCache.h"
+#include <vector>
+
+namespace reco {
+   class MuonMatchBlock {
+      public:
+	 struct ChamberRecord {
+	    float edgeX;
+	    float edgeY;
+	    float x;
+	    float y;
+	    float xErr;
+	    float yErr;
+	    float dXdZ;
+	    float dYdZ;
+	    float dXdZErr;
+	    float dYdZErr;
+	    unsigned int rawId;           // chamber DetId
+	    unsigned int nSegmentMatches; // number of entries in segmentMatches()
+	    unsigned int nRPCMatches;     // number of entries in rpcMatches()
+
+	    ChamberRecord():edgeX(0),edgeY(0),x(0),y(0),xErr(0),yErr(0),dXdZ(0),dYdZ(0),dXdZErr(0),dYdZErr(0),
+	       rawId(0),nSegmentMatches(0),nRPCMatches(0) {}
+	 };
+
+	 /// a chamber of the block with its entries of the flat arrays,
+	 /// valid as long as the block is not modified
+	 class ChamberView {
+	    public:
+	       ChamberView():record_(0),segments_(0),rpcHits_(0) {}
+	       ChamberView( const ChamberRecord* record, const MuonSegmentMatch* segments, const MuonRPCHitMatch* rpcHits ):
+		  record_(record),segments_(segments),rpcHits_(rpcHits) {}
+
+	       const ChamberRecord& record() const { return *record_; }
+	       DetId id() const { return DetId(record_->rawId); }
+	       int detector() const { return id().subdetId(); }
+
+	       unsigned int numberOfSegmentMatches() const { return record_->nSegmentMatches; }
+	       const MuonSegmentMatch* segmentMatchesBegin() const { return segments_; }
+	       const MuonSegmentMatch* segmentMatchesEnd() const { return segments_ + record_->nSegmentMatches; }
+	       unsigned int numberOfRPCMatches() const { return record_->nRPCMatches; }
+	       const MuonRPCHitMatch* rpcMatchesBegin() const { return rpcHits_; }
+	       const MuonRPCHitMatch* rpcMatchesEnd() const { return rpcHits_ + record_->nRPCMatches; }
+
+	       /// the view of the following chamber of the block
+	       ChamberView next() const { return ChamberView(record_+1, segmentMatchesEnd(), rpcMatchesEnd()); }
+
+	    private:
+	       const ChamberRecord* record_;
+	       const MuonSegmentMatch* segments_;
+	       const MuonRPCHitMatch* rpcHits_;
+	 };
+
+	 /// the view of the first chamber, for a non-empty block; the
+	 /// others follow with ChamberView::next()
+	 ChamberView firstChamber() const;
+
+	 /// replace the content by the given chamber matches, keeping the
+	 /// given number of mantissa bits of the float members; the default
+	 /// keeps the full precision
+	 void pack( const std::vector<MuonChamberMatch>& matches,
+		    const muon::MuonMatchPrecision& precision = muon::MuonMatchPrecision() );
+	 /// replace the content by the given flat arrays
+	 void pack( const std::vector<ChamberRecord>& chambers, const std::vector<MuonSegmentMatch>& segmentMatches,
+		    const std::vector<MuonRPCHitMatch>& rpcMatches,
+		    const muon::MuonMatchPrecision& precision = muon::MuonMatchPrecision() );
+	 /// rebuild the chamber matches
+	 void unpack( std::vector<MuonChamberMatch>& matches ) const;
+	 void clear();
+
+	 bool empty() const { return words_.empty(); }
+	 /// number of chambers
+	 unsigned int size() const { return words_.empty() ? 0 : words_[NumberOfChambers]; }
+
+	 /// the decoded flat arrays
+	 const std::vector<ChamberRecord>&    chambers()       const { return content().chambers; }
+	 /// segment matches, chamber by chamber
+	 const std::vector<MuonSegmentMatch>& segmentMatches() const { return content().segmentMatches; }
+	 const std::vector<MuonRPCHitMatch>&  rpcMatches()     const { return content().rpcMatches; }
+
+	 /// size of the persistent buffer, in bytes
+	 unsigned int bufferSize() const { return words_.size()*sizeof(unsigned int); }
+
+	 void swap( MuonMatchBlock& other );
+
+      private:
+	 /// header words of the buffer, before the encoded matches
+	 enum HeaderWord { Format = 0, NumberOfChambers, NumberOfSegmentMatches, NumberOfRPCMatches, HeaderSize };
+
+	 struct Content {
+	    std::vector<ChamberRecord>    chambers;
+	    std::vector<MuonSegmentMatch> segmentMatches;
+	    std::vector<MuonRPCHitMatch>  rpcMatches;
+	 };
+
+	 /// the decoded buffer, decoded on first call
+	 const Content& content() const;
+
+	 std::vector<unsigned int> words_;
+	 /// the products of the DT and of the CSC segments referred to
+	 edm::RefCore dtSegmentProduct_;
+	 edm::RefCore cscSegmentProduct_;
+	 /// transient: the decoded buffer
+	 edm::AtomicPtrCache<Content> content_;
+   };
+}
+
+#endif
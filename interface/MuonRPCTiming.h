@@ -0,0 +1,61 @@
+#ifndef MuonReco_MuonRPCTiming_h
+#define MuonReco_MuonRPCTiming_h
+
+/** \class muon::MuonRPCTiming
+ *
+ *  Summary of the bunch crossings of the RPC hits matched to a muon,
+ *  made in one pass over its RPC chamber matches: the histogram of the
+ *  hit BX, the BX of most of the hits, the mean and spread of the BX
+ *  and the RPC layers with a hit in time, i.e. at BX 0. The layers are
+ *  numbered as in reco::Muon::RPClayerMask.
+ *
+ *  It needs no fit nor geometry and is meant as a cheap pre-filter
+ *  for the out-of-time and slow particle selections, before the DT and
+ *  CSC timing is looked at.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include <vector>
+
+namespace reco {
+   class MuonChamberMatch;
+}
+
+namespace muon {
+
+   struct MuonRPCTiming {
+      /// BX range of the histogram; hits outside of it are counted in the first or last bin
+      enum { minBX = -3, maxBX = 3, nBX = maxBX - minBX + 1 };
+
+      unsigned short bxHits[nBX];    // number of hits at BX minBX + i
+      unsigned short nHits;
+      int majorityBX;                // ties go to the BX closest to 0, then to the earlier one
+      float meanBX;
+      float spreadBX;                // RMS of the hit BX
+      unsigned int layerMask;        // RPC layers with a hit
+      unsigned int inTimeLayerMask;  // RPC layers with a hit at BX 0
+
+      MuonRPCTiming();
+
+      unsigned short hitsAtBX( int bx ) const { return bx < minBX || bx > maxBX ? 0 : bxHits[bx - minBX]; }
+      int numberOfLayers() const;
+      int numberOfInTimeLayers() const;
+
+      /// at least minHits hits, most of them out of BX 0
+      bool isOutOfTime( unsigned int minHits = 2 ) const { return nHits >= minHits && majorityBX != 0; }
+   };
+
+   /// the RPC layer of an RPC chamber match, from 1 to 10
+   int rpcLayer( const reco::MuonChamberMatch& match );
+
+   /// the RPC timing of one muon
+   MuonRPCTiming rpcTiming( const reco::Muon& muon );
+
+   /// the RPC timing of all the muons of a collection, one entry per muon;
+   /// returns the number of out-of-time muons for the given minHits
+   unsigned int fillRPCTimings( const reco::MuonCollection& muons, std::vector<MuonRPCTiming>& timings,
+				unsigned int minHits = 2 );
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef MuonReco_MuonReducedPrecision_h
+#define MuonReco_MuonReducedPrecision_h
+
+/** \file MuonReducedPrecision.h
+ *
+ *  Opt-in reduced precision storage of the chamber and segment matches,
+ *  and the half float encoding of the 1/beta fits of the timing block.
+ *
+ *  A float kept with b mantissa bits is rounded to nearest, which keeps
+ *  a relative precision of 2^-(b+1): |v' - v| <= |v| * 2^-(b+1) for
+ *  normal floats (|v| > 1.2e-38). The absolute precision therefore grows
+ *  with the value. For positions in cm, 12 bits give 1.2e-4, i.e. 1.2
+ *  micron at 1 cm but 120 micron at 1 m, and 16 bits give 7.6e-6, i.e.
+ *  7.6 micron at 1 m.
+ *
+ *  Zero, infinities, NaN and the "not available" sentinels used by the
+ *  matching (|v| >= 9e5, e.g. 999999) are kept exactly.
+ *
+ *  The chamber and segment matches are rounded in the persistent buffer
+ *  of reco::MuonMatchBlock only, see MuonMatchBlock::pack and
+ *  reco::Muon::packMatches: the objects in memory are left untouched.
+ *
+ */
+
+#include <cstring>
+#include <stdint.h>
+
+namespace muon {
+
+   /// number of mantissa bits (0-23) kept for each kind of quantity; 23
+   /// keeps the full float precision
+   struct MuonMatchPrecision {
+      int positionBits;   // x, y, edgeX, edgeY, rpc x, segment t0
+      int slopeBits;      // dXdZ, dYdZ
+      int errorBits;      // all the uncertainties
+
+      /// the default keeps the full precision
+      MuonMatchPrecision( int position = 23, int slope = 23, int error = 23 ):
+	positionBits(position), slopeBits(slope), errorBits(error) {}
+
+      /// the recommended reduced precision: positions to 7.6e-6, i.e.
+      /// 7.6 micron at 1 m, slopes to 1.2e-4 and errors to 0.4%. A chamber
+      /// match then takes 270 bits of the buffer instead of 384, a segment
+      /// match with its segment reference 247 instead of 354
+      static MuonMatchPrecision reduced() { return MuonMatchPrecision(16, 12, 7); }
+
+      /// relative precision guaranteed for a given number of bits
+      static double relativePrecision( int bits ) { return 1./double(2<<bits); }
+   };
+
+   /// round a float to nearest with the given number of mantissa bits
+   inline float reduceMantissa( float value, int bits )
+   {
+      if (bits >= 23 || bits < 0 || value == 0.f || value >= 9e5f || value <= -9e5f) return value;
+      uint32_t word;
+      std::memcpy(&word, &value, sizeof(word));
+      if ((word & 0x7f800000u) == 0x7f800000u) return value;   // inf, nan
+      const int shift = 23 - bits;
+      const uint32_t mask = ~((1u<<shift) - 1u);
+      word = (word + (1u<<(shift-1))) & mask;   // a carry into the exponent is the correct rounding
+      std::memcpy(&value, &word, sizeof(word));
+      return value;
+   }
+
+   /// IEEE 754 half precision encoding of a float, rounded to nearest
+   /// even: 11 significant bits, normal values up to 65504, larger ones
+   /// becoming infinities
+   inline uint16_t floatToHalf( float value )
+   {
+      uint32_t word;
+      std::memcpy(&word, &value, sizeof(word));
+      const uint16_t sign = (word >> 16) & 0x8000u;
+      const uint32_t magnitude = word & 0x7fffffffu;
+      if (magnitude > 0x7f800000u) return sign | 0x7e00u;      // nan
+      if (magnitude >= 0x47800000u) return sign | 0x7c00u;     // inf, or beyond the largest half
+      uint32_t half, rest, tie;
+      if (magnitude < 0x38800000u) {                           // half subnormal or zero
+	 if (magnitude <= 0x33000000u) return sign;
+	 const uint32_t exponent = magnitude >> 23;
+	 const uint32_t mantissa = (magnitude & 0x7fffffu) | 0x800000u;
+	 const uint32_t shift = 126 - exponent;
+	 half = mantissa >> shift;
+	 rest = mantissa & ((1u<<shift) - 1u);
+	 tie = 1u<<(shift-1);
+      } else {
+	 half = (magnitude - 0x38000000u) >> 13;
+	 rest = magnitude & 0x1fffu;
+	 tie = 0x1000u;
+      }
+      if (rest > tie || (rest == tie && (half & 1u))) ++half;  // a carry into the exponent is the correct rounding
+      return sign | half;
+   }
+
+   inline float halfToFloat( uint16_t half )
+   {
+      const uint32_t sign = uint32_t(half & 0x8000u) << 16;
+      const uint32_t exponent = (half >> 10) & 0x1fu;
+      const uint32_t mantissa = half & 0x3ffu;
+      uint32_t word;
+      if (exponent == 0) {
+	 const float value = mantissa * (1.f/16777216.f);      // 2^-24 units
+	 return sign ? -value : value;
+      }
+      if (exponent == 31) word = sign | 0x7f800000u | (mantissa << 13);
+      else word = sign | ((exponent + 112) << 23) | (mantissa << 13);
+      float value;
+      std::memcpy(&value, &word, sizeof(word));
+      return value;
+   }
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <cmath>
 
+#include "DataFormats/Common/interface/RefCore.h"
 #include "DataFormats/DTRecHit/interface/DTRecSegment4DCollection.h"
 #include "DataFormats/CSCRecHit/interface/CSCSegmentCollection.h"
 
@@ -44,14 +45,48 @@ namespace reco {
          void setMask( unsigned int flag ) { mask |= flag; }
          float t0;
 
-         DTRecSegment4DRef  dtSegmentRef;
-         CSCSegmentRef      cscSegmentRef;
+         /// type of the matched segment; a match refers to at most one segment
+         enum SegmentType { NoSegment = 0, DTSegment = 1, CSCSegment = 2 };
 
       MuonSegmentMatch():x(0),y(0),xErr(0),yErr(0),dXdZ(0),dYdZ(0),
-      dXdZErr(0),dYdZErr(0) {}
+      dXdZErr(0),dYdZErr(0),segmentKey_(0) {}
 
          bool hasZed() const { return hasZed_; }
          bool hasPhi() const { return hasPhi_; }
+
+         SegmentType segmentType() const { return SegmentType(segmentKey_>>30); }
+         // Up to ClassVersion 10 dtSegmentRef and cscSegmentRef were public
+         // data members; code using them must change from
+         //    ref = match.dtSegmentRef;     to  ref = match.dtSegmentRef();
+         //    match.dtSegmentRef = ref;     to  match.setDTSegmentRef(ref);
+         //    match.dtSegmentRef.isNull()   to  match.segmentType() != DTSegment
+         // and likewise for cscSegmentRef and setCSCSegmentRef.
+         /// reference to the matched DT segment; null if the match is not a DT segment
+         DTRecSegment4DRef dtSegmentRef() const;
+         /// reference to the matched CSC segment; null if the match is not a CSC segment
+         CSCSegmentRef cscSegmentRef() const;
+         /// refer to a DT segment; a null reference clears the segment.
+         /// Throws if the key of the segment does not fit in 30 bits.
+         void setDTSegmentRef( const DTRecSegment4DRef& ref );
+         /// refer to a CSC segment; a null reference clears the segment.
+         /// Throws if the key of the segment does not fit in 30 bits.
+         void setCSCSegmentRef( const CSCSegmentRef& ref );
+
+         /// true if both matches refer to the same (non-null) segment
+         bool isSameSegment( const MuonSegmentMatch& other ) const {
+            return segmentKey_ == other.segmentKey_ && segmentKey_ != 0 &&
+               segmentProduct_.id() == other.segmentProduct_.id();
+         }
+
+      private:
+         // Only one of the DT and CSC segment references is ever set, so the
+         // match keeps a single product reference and packs the segment type
+         // in the two upper bits of the key: (type<<30)|key.
+         // The product reference is still held by every match, so that
+         // dtSegmentRef() and cscSegmentRef() work on a match on its own;
+         // the products are shared only in the packed MuonMatchBlock.
+         edm::RefCore segmentProduct_;
+         unsigned int segmentKey_;
    };
 }
 
@@ -8,10 +8,12 @@
 // $Id: MuonSelectors.h,v 1.16 2012/08/11 13:00:33 gpetrucc Exp $
 
 #include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonTrackTable.h"
 #include "TMath.h"
 #include <string>
 
 namespace reco{class Vertex;}
+namespace muon{struct MuonSnapshotRow;}
 
 namespace muon {
    /// Selector type
@@ -58,6 +60,15 @@ namespace muon {
    bool isGoodMuon( const reco::Muon& muon, SelectionType type, 
 		    reco::Muon::ArbitrationType arbitrationType = reco::Muon::SegmentAndTrackArbitration);
 
+   // Same, with the tracks of the muon taken from its row of a
+   // muon::MuonTrackTable instead of its TrackRefs.
+   bool isGoodMuon( const reco::Muon& muon, const MuonTrackRow& tracks, SelectionType type,
+		    reco::Muon::ArbitrationType arbitrationType = reco::Muon::SegmentAndTrackArbitration);
+
+   // Same, with the tracks of a muon replayed from a muon::MuonSnapshot.
+   bool isGoodMuon( const reco::Muon& muon, const MuonSnapshotRow& tracks, SelectionType type,
+		    reco::Muon::ArbitrationType arbitrationType = reco::Muon::SegmentAndTrackArbitration);
+
    // ===========================================================================
    //                               Support functions
    // 
@@ -86,6 +97,16 @@ namespace muon {
    bool isLooseMuon(const reco::Muon&);
    bool isSoftMuon(const reco::Muon&, const reco::Vertex&);
    bool isHighPtMuon(const reco::Muon&, const reco::Vertex&);
+
+   // Same, with the tracks taken from the row of a muon::MuonTrackTable.
+   bool isTightMuon(const reco::Muon&, const MuonTrackRow&, const reco::Vertex&);
+   bool isSoftMuon(const reco::Muon&, const MuonTrackRow&, const reco::Vertex&);
+   bool isHighPtMuon(const reco::Muon&, const MuonTrackRow&, const reco::Vertex&);
+
+   // Same, with the tracks replayed from a muon::MuonSnapshot.
+   bool isTightMuon(const reco::Muon&, const MuonSnapshotRow&, const reco::Vertex&);
+   bool isSoftMuon(const reco::Muon&, const MuonSnapshotRow&, const reco::Vertex&);
+   bool isHighPtMuon(const reco::Muon&, const MuonSnapshotRow&, const reco::Vertex&);
    
    // determine if station was crossed well withing active volume
    unsigned int RequiredStationMask( const reco::Muon& muon,
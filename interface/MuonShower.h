@@ -4,19 +4,27 @@
 namespace reco {
     struct MuonShower {
 
+      /// number of muon stations, the index of station n being n-1
+      static const unsigned int nStations = 4;
+
       /// number of all the muon RecHits per chamber crossed by a track (1D hits)
-      std::vector<int> nStationHits;
+      int nStationHits[nStations];
       /// number of the muon RecHits used by segments per chamber crossed by a track
-      std::vector<int> nStationCorrelatedHits;
+      int nStationCorrelatedHits[nStations];
       /// the transverse size of the hit cluster
-      std::vector<float> stationShowerSizeT;
+      float stationShowerSizeT[nStations];
       /// the radius of the cone containing the all the hits around the track
-      std::vector<float> stationShowerDeltaR;
+      float stationShowerDeltaR[nStations];
 
-      MuonShower():
-	nStationHits(0),nStationCorrelatedHits(0),
-	stationShowerSizeT(0),stationShowerDeltaR(0)
-      { }       
+      MuonShower()
+      {
+	for (unsigned int i = 0; i < nStations; ++i) {
+	  nStationHits[i] = 0;
+	  nStationCorrelatedHits[i] = 0;
+	  stationShowerSizeT[i] = 0;
+	  stationShowerDeltaR[i] = 0;
+	}
+      }
     };
 }
 #endif
@@ -0,0 +1,56 @@
+#ifndef MuonReco_MuonShowerMatrix_h
+#define MuonReco_MuonShowerMatrix_h
+
+/** \class muon::MuonShowerMatrix
+ *
+ *  The MuonShower of all the muons of a collection, read from the
+ *  ValueMap at once into one station x muon matrix per quantity: the
+ *  values of one station for all the muons are contiguous, ready for
+ *  loops over the muons.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonShower.h"
+#include "DataFormats/Common/interface/ValueMap.h"
+#include <vector>
+
+namespace muon {
+
+   class MuonShowerMatrix {
+   public:
+      MuonShowerMatrix():nMuons_(0) {}
+
+      /// the n showers of an array, in that order
+      void fill( const reco::MuonShower* showers, unsigned int n );
+      /// the showers of the muons of the collection, in the key order;
+      /// throws if the map has no entry for it
+      void fill( const edm::ValueMap<reco::MuonShower>& showers, const reco::MuonRefProd& muons );
+
+      unsigned int numberOfMuons() const { return nMuons_; }
+
+      /// the values of station index s for the muons 0 to numberOfMuons()-1;
+      /// null when there are no muons
+      const int*   nStationHits( unsigned int s )           const { return row(nStationHits_, s); }
+      const int*   nStationCorrelatedHits( unsigned int s ) const { return row(nStationCorrelatedHits_, s); }
+      const float* stationShowerSizeT( unsigned int s )     const { return row(stationShowerSizeT_, s); }
+      const float* stationShowerDeltaR( unsigned int s )    const { return row(stationShowerDeltaR_, s); }
+
+      int   nStationHits( unsigned int s, unsigned int i )           const { return nStationHits_[s*nMuons_+i]; }
+      int   nStationCorrelatedHits( unsigned int s, unsigned int i ) const { return nStationCorrelatedHits_[s*nMuons_+i]; }
+      float stationShowerSizeT( unsigned int s, unsigned int i )     const { return stationShowerSizeT_[s*nMuons_+i]; }
+      float stationShowerDeltaR( unsigned int s, unsigned int i )    const { return stationShowerDeltaR_[s*nMuons_+i]; }
+
+   private:
+      template<typename T>
+      const T* row( const std::vector<T>& values, unsigned int s ) const { return nMuons_ ? &values[s*nMuons_] : 0; }
+
+      unsigned int nMuons_;
+      std::vector<int>   nStationHits_;
+      std::vector<int>   nStationCorrelatedHits_;
+      std::vector<float> stationShowerSizeT_;
+      std::vector<float> stationShowerDeltaR_;
+   };
+}
+
+#endif
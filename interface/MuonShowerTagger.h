@@ -0,0 +1,49 @@
+#ifndef MuonReco_MuonShowerTagger_h
+#define MuonReco_MuonShowerTagger_h
+
+/** \class muon::MuonShowerHits
+ *
+ *  Computation of the MuonShower quantities from the muon hits around
+ *  the trajectory, station by station: the number of hits, the number
+ *  of them used by segments, the transverse size of the hits, i.e. the
+ *  distance between the two outermost of them, and the deltaR of the
+ *  cone around the trajectory containing all of them.
+ *
+ *  The hits are given as flat arrays of their positions relative to
+ *  the trajectory crossing point in their station, grouped by muon and
+ *  by station, for one muon or a whole collection at once. Each station
+ *  is reduced in a single loop over its hits, without branches, which
+ *  the compiler vectorizes.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonShower.h"
+#include <stdint.h>
+#include <vector>
+
+namespace muon {
+
+   struct MuonShowerHits {
+      /// eta and phi of the hits minus the ones of the trajectory, phi
+      /// within [-pi, pi]
+      const float* deltaEta;
+      const float* deltaPhi;
+      /// signed transverse distance of the hits to the trajectory, in cm
+      const float* deltaT;
+      /// 1 for the hits used by a segment, 0 otherwise
+      const uint8_t* correlated;
+      /// nMuons*nStations+1 offsets in the arrays: the hits of station
+      /// index s of muon i are [offsets[i*nStations+s], offsets[i*nStations+s+1])
+      const unsigned int* offsets;
+
+      MuonShowerHits():deltaEta(0),deltaPhi(0),deltaT(0),correlated(0),offsets(0) {}
+   };
+
+   /// the shower of muon i of the hits
+   reco::MuonShower muonShower( const MuonShowerHits& hits, unsigned int i = 0 );
+
+   /// the showers of the nMuons muons of the hits, in that order
+   void fillMuonShowers( const MuonShowerHits& hits, unsigned int nMuons, std::vector<reco::MuonShower>& showers );
+}
+
+#endif
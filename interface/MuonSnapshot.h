@@ -0,0 +1,209 @@
+#ifndef MuonReco_MuonSnapshot_h
+#define MuonReco_MuonSnapshot_h
+
+/** \class muon::MuonSnapshot
+ *
+ *  Self-contained binary snapshot of muon collections, to replay the
+ *  selectors and cocktails outside the framework. A
+ *  muon::MuonSnapshotWriter collects the muons of any number of events
+ *  together with their chamber matches, the quantities of their tracks
+ *  used by the selectors and their cocktail inputs, and writes them as
+ *  flat arrays of plain records. muon::MuonSnapshot maps such a file
+ *  into memory and gives direct access to these arrays without copying
+ *  them:
+ *
+ *   - cocktailInputs() can be passed as is to tevOptimizedChoice(s),
+ *   - trackRow(i) gives the tracks of a muon in the form taken by the
+ *     isGoodMuon, isTightMuon, isSoftMuon and isHighPtMuon overloads,
+ *   - fillMuon(i, muon) rebuilds the reco::Muon itself, matches
+ *     included, for the algorithms working on the muon.
+ *
+ *  Only cocktailInputs() and the tracks of trackRow(i) are read in
+ *  place. The selectors still take a reco::Muon next to the track row,
+ *  so a selector replay calls fillMuon(i, muon) for every muon, which
+ *  allocates the chamber matches again: it measures the selectors
+ *  without the framework and the ROOT read, not at memory bandwidth.
+ *
+ *  fillMatches and fillMuon throw cms::Exception if the chambers or the
+ *  matches of the muon lie beyond the sections of the file.
+ *
+ *  Segment references, track references and the calorimeter energy
+ *  are not stored. The file uses the native byte order and layout and
+ *  is only meant to be read back on the same kind of machine.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonCocktails.h"
+#include "DataFormats/MuonReco/interface/MuonMatchBlock.h"
+#include "DataFormats/MuonReco/interface/MuonTrackTable.h"
+#include "DataFormats/Math/interface/Point3D.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace muon {
+
+  /// the hit pattern counts used by the selectors
+  struct MuonSnapshotHitPattern {
+    uint16_t validMuonHits;
+    uint16_t validPixelHits;
+    uint16_t trackerLayers;
+    uint16_t pixelLayers;
+
+    int numberOfValidMuonHits()        const { return validMuonHits; }
+    int numberOfValidPixelHits()       const { return validPixelHits; }
+    int trackerLayersWithMeasurement() const { return trackerLayers; }
+    int pixelLayersWithMeasurement()   const { return pixelLayers; }
+  };
+
+  /// the quantities of a track used by the selectors, with the same
+  /// accessors as reco::Track
+  struct MuonSnapshotTrack {
+    double pt_, ptError_;
+    double chi2_, ndof_;
+    double vx_, vy_, vz_;
+    double px_, py_, pz_;
+    MuonSnapshotHitPattern hitPattern_;
+
+    double pt()      const { return pt_; }
+    double ptError() const { return ptError_; }
+    double chi2()    const { return chi2_; }
+    double ndof()    const { return ndof_; }
+    double normalizedChi2() const { return ndof_ != 0 ? chi2_ / ndof_ : chi2_ * 1e6; }
+    const MuonSnapshotHitPattern& hitPattern() const { return hitPattern_; }
+    double dxy( const math::XYZPoint& p ) const {
+      return ( - (vx_-p.x()) * py_ + (vy_-p.y()) * px_ ) / pt_;
+    }
+    double dz( const math::XYZPoint& p ) const {
+      return (vz_-p.z()) - ( (vx_-p.x()) * px_ + (vy_-p.y()) * py_ ) / pt_ * ( pz_ / pt_ );
+    }
+  };
+
+  /// the segment matches without their segment references
+  struct MuonSnapshotSegment {
+    float x, y, xErr, yErr;
+    float dXdZ, dYdZ, dXdZErr, dYdZErr;
+    float t0;
+    uint32_t mask;
+    uint8_t hasZed, hasPhi;
+  };
+
+  /// one muon; its chambers are chambers()[firstChamber, firstChamber+nChambers),
+  /// the matches of the chambers following each other from firstSegment and firstRPCHit
+  struct MuonSnapshotRecord {
+    enum { MatchesValid = 1<<0, IsolationValid = 1<<1, PFIsolationValid = 1<<2, QualityValid = 1<<3 };
+
+    double px, py, pz, energy;
+    double vx, vy, vz;
+    int32_t charge;
+    uint32_t type;
+    uint32_t flags;
+    uint8_t bestTrackType;
+    uint8_t tunePBestTrackType;
+    uint8_t nPFIsolations;
+    float caloCompatibility;
+    reco::MuonIsolation isolationR03;
+    reco::MuonIsolation isolationR05;
+    reco::MuonPFIsolation pfIsolations[reco::Muon::nPFIsolationTypes];
+    reco::MuonQuality combinedQuality;
+    reco::MuonTime time;
+    uint32_t firstChamber, nChambers;
+    uint32_t firstSegment, firstRPCHit;
+  };
+
+  /// tracks of a muon of a snapshot, in the form taken by the selectors
+  struct MuonSnapshotRow {
+    const MuonSnapshotTrack* tracks;  // MuonTrackRow::nTrackTypes entries
+    const uint8_t* valid;             // whether each of them exists
+    reco::Muon::MuonTrackType bestTrackType;
+    reco::Muon::MuonTrackType tunePBestTrackType;
+
+    const MuonSnapshotTrack* track( const reco::Muon::MuonTrackType type ) const {
+      return type > reco::Muon::None && int(type) < MuonTrackRow::nTrackTypes && valid[type] ? tracks+type : 0;
+    }
+    const MuonSnapshotTrack* innerTrack()     const { return track(reco::Muon::InnerTrack); }
+    const MuonSnapshotTrack* outerTrack()     const { return track(reco::Muon::OuterTrack); }
+    const MuonSnapshotTrack* globalTrack()    const { return track(reco::Muon::CombinedTrack); }
+    const MuonSnapshotTrack* bestTrack()      const { return track(bestTrackType); }
+    const MuonSnapshotTrack* tunePBestTrack() const { return track(tunePBestTrackType); }
+  };
+
+  struct MuonSnapshotHeader {
+    enum { Events, Muons, TrackValid, Tracks, CocktailInputs, Chambers, Segments, RPCHits, nSections };
+    char magic[8];
+    uint32_t version;
+    uint32_t nEvents;
+    uint32_t nMuons;
+    uint32_t nChambers;
+    uint32_t nSegments;
+    uint32_t nRPCHits;
+    uint64_t offsets[nSections];   // from the start of the file
+  };
+
+  class MuonSnapshotWriter {
+  public:
+    /// append the muons of one event
+    void addEvent( const reco::MuonCollection& muons );
+    /// write everything added so far; throws cms::Exception on failure
+    void write( const std::string& fileName ) const;
+
+    unsigned int numberOfEvents() const { return events_.empty() ? 0 : events_.size()-1; }
+    unsigned int numberOfMuons() const { return muons_.size(); }
+    void clear();
+
+  private:
+    std::vector<uint32_t> events_;   // first muon of each event, plus the total
+    std::vector<MuonSnapshotRecord> muons_;
+    std::vector<uint8_t> trackValid_;
+    std::vector<MuonSnapshotTrack> tracks_;
+    std::vector<MuonCocktailInputs> cocktailInputs_;
+    std::vector<reco::MuonMatchBlock::ChamberRecord> chambers_;
+    std::vector<MuonSnapshotSegment> segments_;
+    std::vector<reco::MuonRPCHitMatch> rpcHits_;
+  };
+
+  class MuonSnapshot {
+  public:
+    /// map the file; throws cms::Exception if it cannot be read
+    explicit MuonSnapshot( const std::string& fileName );
+    ~MuonSnapshot();
+
+    unsigned int numberOfEvents() const { return header_->nEvents; }
+    unsigned int numberOfMuons() const { return header_->nMuons; }
+    /// the muons of event iEvent are [firstMuon(iEvent), firstMuon(iEvent+1))
+    unsigned int firstMuon( unsigned int iEvent ) const { return events_[iEvent]; }
+
+    const MuonSnapshotRecord* muons() const { return muons_; }
+    const MuonCocktailInputs* cocktailInputs() const { return cocktailInputs_; }
+    const reco::MuonMatchBlock::ChamberRecord* chambers() const { return chambers_; }
+    const MuonSnapshotSegment* segments() const { return segments_; }
+    const reco::MuonRPCHitMatch* rpcHits() const { return rpcHits_; }
+
+    MuonSnapshotRow trackRow( unsigned int iMuon ) const;
+    /// rebuild muon iMuon, without its track references
+    void fillMuon( unsigned int iMuon, reco::Muon& muon ) const;
+    /// rebuild the chamber matches of muon iMuon
+    void fillMatches( unsigned int iMuon, std::vector<reco::MuonChamberMatch>& matches ) const;
+
+  private:
+    MuonSnapshot( const MuonSnapshot& );
+    MuonSnapshot& operator=( const MuonSnapshot& );
+
+    void* data_;
+    size_t size_;
+    const MuonSnapshotHeader* header_;
+    const uint32_t* events_;
+    const MuonSnapshotRecord* muons_;
+    const uint8_t* trackValid_;
+    const MuonSnapshotTrack* tracks_;
+    const MuonCocktailInputs* cocktailInputs_;
+    const reco::MuonMatchBlock::ChamberRecord* chambers_;
+    const MuonSnapshotSegment* segments_;
+    const reco::MuonRPCHitMatch* rpcHits_;
+  };
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef MuonReco_MuonTable_h
+#define MuonReco_MuonTable_h
+
+/** \class muon::MuonTable
+ *
+ *  Columnar copy of a muon collection: one contiguous array per
+ *  quantity, filled in a single pass over the collection, so that
+ *  analysis cuts can run as plain loops over arrays instead of
+ *  virtual calls on each reco::Muon.
+ *
+ *  The groups of columns to fill are chosen at compile time with the
+ *  Fields bit mask, e.g. MuonTable<Kinematics|TypeFlags|Isolation>;
+ *  the columns of the other groups stay empty.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include <vector>
+
+namespace muon {
+
+  /// groups of columns of a MuonTable
+  enum MuonTableField {
+    Kinematics        = 1<<0,  // pt, eta, phi, charge
+    TypeFlags         = 1<<1,  // type_ bits
+    BestTrackTypes    = 1<<2,  // muonBestTrackType and tunePMuonBestTrackType
+    Isolation         = 1<<3,  // detector isolation R03 and PF isolation R04 sums
+    CaloCompatibility = 1<<4,
+    StationMasks      = 1<<5,  // stationMask and numberOfMatchedStations
+    Time              = 1<<6,  // MuonTime fields
+    AllMuonTableFields = (1<<7)-1
+  };
+
+  template <unsigned int Fields>
+  struct MuonTable {
+    // Kinematics
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<float> phi;
+    std::vector<int>   charge;
+    // TypeFlags
+    std::vector<unsigned int> type;
+    // BestTrackTypes
+    std::vector<unsigned char> bestTrackType;
+    std::vector<unsigned char> tunePBestTrackType;
+    // Isolation
+    std::vector<float> trkSumPtR03;
+    std::vector<float> emEtR03;
+    std::vector<float> hadEtR03;
+    std::vector<float> hoEtR03;
+    std::vector<float> pfChargedHadronPtR04;
+    std::vector<float> pfNeutralHadronEtR04;
+    std::vector<float> pfPhotonEtR04;
+    std::vector<float> pfPUPtR04;
+    // CaloCompatibility
+    std::vector<float> caloCompatibility;
+    // StationMasks
+    std::vector<unsigned int> stationMask;
+    std::vector<int>          numberOfMatchedStations;
+    // Time
+    std::vector<int>   timeNDof;
+    std::vector<float> timeAtIpInOut;
+    std::vector<float> timeAtIpInOutErr;
+    std::vector<float> timeAtIpOutIn;
+    std::vector<float> timeAtIpOutInErr;
+    std::vector<float> inverseBeta;
+    std::vector<float> inverseBetaErr;
+    std::vector<float> freeInverseBeta;
+    std::vector<float> freeInverseBetaErr;
+
+    static bool has( MuonTableField field ) { return (Fields & field) != 0; }
+
+    unsigned int size() const { return size_; }
+
+    /// replace the content by one row per muon of the collection; the
+    /// station masks use the given arbitration
+    void fill( const reco::MuonCollection& muons,
+	       reco::Muon::ArbitrationType arbitration = reco::Muon::SegmentAndTrackArbitration )
+    {
+      clear();
+      reserve( muons.size() );
+      for ( reco::MuonCollection::const_iterator muon = muons.begin(); muon != muons.end(); ++muon ) {
+	if ( Fields & Kinematics ) {
+	  pt.push_back( muon->pt() );
+	  eta.push_back( muon->eta() );
+	  phi.push_back( muon->phi() );
+	  charge.push_back( muon->charge() );
+	}
+	if ( Fields & TypeFlags )
+	  type.push_back( muon->type() );
+	if ( Fields & BestTrackTypes ) {
+	  bestTrackType.push_back( muon->muonBestTrackType() );
+	  tunePBestTrackType.push_back( muon->tunePMuonBestTrackType() );
+	}
+	if ( Fields & Isolation ) {
+	  const reco::MuonIsolation& iso = muon->isolationR03();
+	  trkSumPtR03.push_back( iso.sumPt );
+	  emEtR03.push_back( iso.emEt );
+	  hadEtR03.push_back( iso.hadEt );
+	  hoEtR03.push_back( iso.hoEt );
+	  const reco::MuonPFIsolation& pfIso = muon->pfIsolationR04();
+	  pfChargedHadronPtR04.push_back( pfIso.sumChargedHadronPt );
+	  pfNeutralHadronEtR04.push_back( pfIso.sumNeutralHadronEt );
+	  pfPhotonEtR04.push_back( pfIso.sumPhotonEt );
+	  pfPUPtR04.push_back( pfIso.sumPUPt );
+	}
+	if ( Fields & CaloCompatibility )
+	  caloCompatibility.push_back( muon->caloCompatibility() );
+	if ( Fields & StationMasks ) {
+	  unsigned int mask = muon->stationMask( arbitration );
+	  stationMask.push_back( mask );
+	  int nStations = 0;
+	  for ( unsigned int bits = mask; bits; bits &= bits-1 ) ++nStations;
+	  numberOfMatchedStations.push_back( nStations );
+	}
+	if ( Fields & Time ) {
+	  const reco::MuonTime& time = muon->time();
+	  timeNDof.push_back( time.nDof );
+	  timeAtIpInOut.push_back( time.timeAtIpInOut );
+	  timeAtIpInOutErr.push_back( time.timeAtIpInOutErr );
+	  timeAtIpOutIn.push_back( time.timeAtIpOutIn );
+	  timeAtIpOutInErr.push_back( time.timeAtIpOutInErr );
+	  inverseBeta.push_back( time.inverseBeta() );
+	  inverseBetaErr.push_back( time.inverseBetaErr() );
+	  freeInverseBeta.push_back( time.freeInverseBeta() );
+	  freeInverseBetaErr.push_back( time.freeInverseBetaErr() );
+	}
+      }
+      size_ = muons.size();
+    }
+
+    void clear()
+    {
+      pt.clear(); eta.clear(); phi.clear(); charge.clear();
+      type.clear();
+      bestTrackType.clear(); tunePBestTrackType.clear();
+      trkSumPtR03.clear(); emEtR03.clear(); hadEtR03.clear(); hoEtR03.clear();
+      pfChargedHadronPtR04.clear(); pfNeutralHadronEtR04.clear(); pfPhotonEtR04.clear(); pfPUPtR04.clear();
+      caloCompatibility.clear();
+      stationMask.clear(); numberOfMatchedStations.clear();
+      timeNDof.clear(); timeAtIpInOut.clear(); timeAtIpInOutErr.clear(); timeAtIpOutIn.clear(); timeAtIpOutInErr.clear();
+      inverseBeta.clear(); inverseBetaErr.clear(); freeInverseBeta.clear(); freeInverseBetaErr.clear();
+      size_ = 0;
+    }
+
+    MuonTable() : size_(0) {}
+
+  private:
+    void reserve( unsigned int n )
+    {
+      if ( Fields & Kinematics ) { pt.reserve(n); eta.reserve(n); phi.reserve(n); charge.reserve(n); }
+      if ( Fields & TypeFlags ) type.reserve(n);
+      if ( Fields & BestTrackTypes ) { bestTrackType.reserve(n); tunePBestTrackType.reserve(n); }
+      if ( Fields & Isolation ) {
+	trkSumPtR03.reserve(n); emEtR03.reserve(n); hadEtR03.reserve(n); hoEtR03.reserve(n);
+	pfChargedHadronPtR04.reserve(n); pfNeutralHadronEtR04.reserve(n); pfPhotonEtR04.reserve(n); pfPUPtR04.reserve(n);
+      }
+      if ( Fields & CaloCompatibility ) caloCompatibility.reserve(n);
+      if ( Fields & StationMasks ) { stationMask.reserve(n); numberOfMatchedStations.reserve(n); }
+      if ( Fields & Time ) {
+	timeNDof.reserve(n); timeAtIpInOut.reserve(n); timeAtIpInOutErr.reserve(n);
+	timeAtIpOutIn.reserve(n); timeAtIpOutInErr.reserve(n);
+	inverseBeta.reserve(n); inverseBetaErr.reserve(n); freeInverseBeta.reserve(n); freeInverseBetaErr.reserve(n);
+      }
+    }
+
+    unsigned int size_;
+  };
+
+}
+
+#endif
@@ -1,14 +1,40 @@
 #ifndef MuonReco_MuonTime_h
 #define MuonReco_MuonTime_h
 
+/** \class reco::MuonTime
+ *
+ *  The timing block of a muon. Besides the time at the IP it holds the
+ *  1/beta fits, so that everything is found in the muon itself and no
+ *  MuonTimeExtra is needed any more. MuonTimeExtra is only kept to read
+ *  the ValueMaps of old files, see muon::setTimes.
+ *
+ *  nDof and the times at the IP are the public fields they have always
+ *  been, as full floats. A half float would not do for the times: with
+ *  11 significant bits it steps by 0.25 ns between 256 and 512 ns, and
+ *  anything above 65504 ns, such as the large errors of poorly measured
+ *  muons, would become infinite.
+ *
+ *  The 1/beta fits are of order 1 and are stored as IEEE half floats,
+ *  see muon::floatToHalf in MuonReducedPrecision.h, behind accessors:
+ *  a relative precision of 2^-11 = 4.9e-4, i.e. steps of 1e-3 between 1
+ *  and 2, well below the resolution. The same limits apply: the steps
+ *  grow to 0.25 for values between 256 and 512, and values beyond 65504
+ *  are stored as infinities.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonReducedPrecision.h"
+#include <stdint.h>
 
 namespace reco {
+    class MuonTimeExtra;
+
     struct MuonTime {
        enum Direction { OutsideIn = -1, Undefined = 0, InsideOut = 1 };
-	    
+
        /// number of muon stations used
        int nDof;
-       
+
        /// time of arrival at the IP for the Beta=1 hypothesis
        ///  a) particle is moving from inside out
        float timeAtIpInOut;
@@ -16,19 +42,45 @@ namespace reco {
        ///  b) particle is moving from outside in
        float timeAtIpOutIn;
        float timeAtIpOutInErr;
-       
+
+       /// 1/beta for prompt particle hypothesis
+       /// (time is constraint to the bunch crossing time)
+       float inverseBeta()    const { return muon::halfToFloat(inverseBeta_); }
+       float inverseBetaErr() const { return muon::halfToFloat(inverseBetaErr_); }
+       void setInverseBeta( float inverseBeta ) { inverseBeta_ = muon::floatToHalf(inverseBeta); }
+       void setInverseBetaErr( float error )    { inverseBetaErr_ = muon::floatToHalf(error); }
+       /// unconstrained 1/beta (time is free), positive for outward
+       /// and negative for inward moving particles
+       float freeInverseBeta()    const { return muon::halfToFloat(freeInverseBeta_); }
+       float freeInverseBetaErr() const { return muon::halfToFloat(freeInverseBetaErr_); }
+       void setFreeInverseBeta( float inverseBeta ) { freeInverseBeta_ = muon::floatToHalf(inverseBeta); }
+       void setFreeInverseBetaErr( float error )    { freeInverseBetaErr_ = muon::floatToHalf(error); }
+
        /// direction estimation based on time dispersion
-       Direction direction() const
+       Direction direction() const { return direction(nDof, timeAtIpInOutErr, timeAtIpOutInErr); }
+
+       /// the direction estimation, shared with MuonTimeExtra
+       static Direction direction( int nDof, float timeAtIpInOutErr, float timeAtIpOutInErr )
 	 {
 	    if (nDof<2) return Undefined;
 	    if ( timeAtIpInOutErr > timeAtIpOutInErr ) return OutsideIn;
 	    return InsideOut;
 	 }
-       
-       
+
+
        MuonTime():
-       nDof(0), timeAtIpInOut(0), timeAtIpInOutErr(0), timeAtIpOutIn(0), timeAtIpOutInErr(0)
+       nDof(0), timeAtIpInOut(0), timeAtIpInOutErr(0), timeAtIpOutIn(0), timeAtIpOutInErr(0),
+       inverseBeta_(0), inverseBetaErr_(0), freeInverseBeta_(0), freeInverseBetaErr_(0)
 	 {}
+       /// all the fields of a MuonTimeExtra, for old files
+       explicit MuonTime( const MuonTimeExtra& extra );
+
+    private:
+       /// half floats
+       uint16_t inverseBeta_;
+       uint16_t inverseBetaErr_;
+       uint16_t freeInverseBeta_;
+       uint16_t freeInverseBetaErr_;
     };
 }
 #endif
@@ -0,0 +1,105 @@
+#ifndef MuonReco_MuonTimeClassifier_h
+#define MuonReco_MuonTimeClassifier_h
+
+/** \class muon::MuonTimeClasses
+ *
+ *  Timing classification of all the muons of an event in one pass,
+ *  for the cosmic and beam halo filters. For every muon it gives the
+ *  direction as in MuonTime::direction(), the compatibility of
+ *  inverseBeta with a beta=1 particle as a pull, and flags for the muons
+ *  out of time with respect to the bunch crossing. The same pass counts
+ *  them in a MuonTimeEventSummary, on which an event can be rejected
+ *  before looking at any muon.
+ *
+ *  The input is the timing blocks of the muons of a collection, the
+ *  contiguous results of muon::fitMuonTimes, or, for old files, a
+ *  MuonTimeExtraMap together with the muons it refers to, whose values
+ *  for one collection are contiguous as well. The times are classified
+ *  in blocks copied to local arrays, without branches, so that the
+ *  compiler vectorizes the loop.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonTime.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
+#include <stdint.h>
+#include <vector>
+
+namespace muon {
+
+   struct MuonTimeClassifierParameters {
+      /// measurements needed for a direction and timing decision
+      int minNDof;
+      /// |timeAtIpInOut| in ns beyond which a muon is out of time
+      float maxTimeAtIp;
+      /// |inverseBeta - 1|/inverseBetaErr beyond which a muon is not compatible with beta=1
+      float maxInverseBetaPull;
+
+      MuonTimeClassifierParameters():minNDof(2),maxTimeAtIp(20.),maxInverseBetaPull(3.) {}
+   };
+
+   struct MuonTimeClasses {
+      enum Flag { Measured        = 1<<0,   // nDof >= minNDof
+		  OutsideIn       = 1<<1,
+		  OutOfTime       = 1<<2,
+		  NotRelativistic = 1<<3 };
+
+      /// reco::MuonTime::Direction
+      std::vector<int8_t> direction;
+      /// (inverseBeta - 1)/inverseBetaErr, 0 when not measured
+      std::vector<float> inverseBetaPull;
+      /// Flag mask
+      std::vector<uint8_t> flags;
+
+      unsigned int size() const { return flags.size(); }
+      bool isFlag( unsigned int i, unsigned int mask ) const { return (flags[i] & mask) == mask; }
+      void resize( unsigned int n ) { direction.resize(n); inverseBetaPull.resize(n); flags.resize(n); }
+   };
+
+   struct MuonTimeEventSummary {
+      unsigned int nMuons;
+      unsigned int nMeasured;
+      unsigned int nOutsideIn;
+      unsigned int nOutOfTime;
+      unsigned int nNotRelativistic;
+      /// measured muons inside-out and in time
+      unsigned int nInTime;
+
+      MuonTimeEventSummary():nMuons(0),nMeasured(0),nOutsideIn(0),nOutOfTime(0),nNotRelativistic(0),nInTime(0) {}
+
+      /// muons were measured, but none of them comes in time from the interaction point
+      bool noMuonInTime() const { return nMeasured > 0 && nInTime == 0; }
+      void add( const MuonTimeEventSummary& other ) {
+	 nMuons += other.nMuons; nMeasured += other.nMeasured; nOutsideIn += other.nOutsideIn;
+	 nOutOfTime += other.nOutOfTime; nNotRelativistic += other.nNotRelativistic; nInTime += other.nInTime;
+      }
+   };
+
+   /// classify the muons of a collection from their timing blocks,
+   /// replacing the content of classes
+   MuonTimeEventSummary classifyMuonTimes( const reco::MuonCollection& muons, MuonTimeClasses& classes,
+					   const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+
+   /// classify n muons
+   MuonTimeEventSummary classifyMuonTimes( const reco::MuonTime* times, unsigned int n,
+					   MuonTimeClasses& classes,
+					   const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+
+   /// classify the muons of a collection from their entries in the map;
+   /// throws if the map has no entry for them
+   MuonTimeEventSummary classifyMuonTimes( const reco::MuonTimeExtraMap& times, const reco::MuonRefProd& muons,
+					   MuonTimeClasses& classes,
+					   const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+
+   /// the summary alone, for the filters which only decide on the event
+   MuonTimeEventSummary summarizeMuonTimes( const reco::MuonCollection& muons,
+					    const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+   MuonTimeEventSummary summarizeMuonTimes( const reco::MuonTime* times, unsigned int n,
+					    const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+   MuonTimeEventSummary summarizeMuonTimes( const reco::MuonTimeExtraMap& times, const reco::MuonRefProd& muons,
+					    const MuonTimeClassifierParameters& parameters = MuonTimeClassifierParameters() );
+}
+
+#endif
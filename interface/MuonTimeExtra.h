@@ -5,12 +5,18 @@
  *  
  * A class holding timing information calculated for a muon. 
  *
+ * It is no longer produced: the timing is held by the reco::MuonTime
+ * of the muon. The class is kept to read the ValueMaps of old files,
+ * see muon::setTimes.
+ *
  * \author Piotr Traczyk, CERN
  *
  * \version $Id: MuonTimeExtra.h,v 1.1 2009/03/13 22:58:14 ptraczyk Exp $
  *
  */
 
+#include "DataFormats/MuonReco/interface/MuonTime.h"
+
 namespace reco {
  
   class MuonTimeExtra {
@@ -54,9 +60,7 @@ namespace reco {
       /// direction estimation based on time dispersion
       Direction direction() const
       {
-        if (nDof_<2) return Undefined;
-        if ( timeAtIpInOutErr_ > timeAtIpOutInErr_ ) return OutsideIn;
-        return InsideOut;
+        return Direction( MuonTime::direction(nDof_, timeAtIpInOutErr_, timeAtIpOutInErr_) );
       }
      
     private:
@@ -13,4 +13,11 @@ typedef edm::ValueMap<reco::MuonTimeExtra> MuonTimeExtraMap;
 
 }
 
+namespace muon {
+  /// copy the map entries into the timing blocks of the muons, for the
+  /// files written before reco::MuonTime held the 1/beta fits; muons
+  /// is a copy of the collection of refProd
+  void setTimes( reco::MuonCollection& muons, const reco::MuonRefProd& refProd, const reco::MuonTimeExtraMap& times );
+}
+
 #endif
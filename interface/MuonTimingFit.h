@@ -0,0 +1,128 @@
+#ifndef MuonReco_MuonTimingFit_h
+#define MuonReco_MuonTimingFit_h
+
+/** \class muon::MuonTimeMeasurements
+ *
+ *  Muon timing from the t0 of the matched segments. Each measurement
+ *  is the segment t0, i.e. the time offset with respect to a beta=1
+ *  particle coming from the interaction point, the path length from
+ *  the interaction point to the segment and the t0 uncertainty. The
+ *  measurements of all the muons of a collection are kept in
+ *  contiguous arrays, the ones of muon i being [first[i], first[i+1]).
+ *
+ *  fitMuonTime fills a reco::MuonTime with closed-form weighted
+ *  fits over these arrays:
+ *   - timeAtIpInOut: weighted mean of t0,
+ *   - timeAtIpOutIn: weighted mean of t0 + 2 d/c,
+ *   - inverseBeta: weighted mean of 1 + c t0/d (time constrained to the
+ *     bunch crossing),
+ *   - freeInverseBeta: slope of the straight line fit of the arrival
+ *     time vs d/c (time free).
+ *  The errors of the means are their weighted spread, which is what
+ *  MuonTime::direction() compares, floored at the error from the
+ *  t0 uncertainties alone; the free fit error is the one of the fitted
+ *  slope. Measurements at distance 0 do not enter inverseBeta, which
+ *  is left at its default when there is no other.
+ *
+ *  The path lengths need the chamber geometry, which the caller
+ *  provides with a functor
+ *     double operator()( const reco::MuonChamberMatch&, const reco::MuonSegmentMatch& ) const
+ *  returning the distance in cm from the interaction point to the segment.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/MuonSegmentMatch.h"
+#include "DataFormats/MuonReco/interface/MuonTime.h"
+#include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
+#include <vector>
+
+namespace muon {
+
+   struct MuonTimingParameters {
+      /// t0 uncertainties in ns, which set the weights of the fits
+      double dtTimeError;
+      double cscTimeError;
+      /// segments used, by their arbitration mask
+      unsigned int segmentMask;
+
+      MuonTimingParameters():
+	dtTimeError(3.), cscTimeError(7.),
+	segmentMask(reco::MuonSegmentMatch::BestInChamberByDR | reco::MuonSegmentMatch::BelongsToTrackByDR)
+      {}
+   };
+
+   struct MuonTimeMeasurements {
+      std::vector<double> t0;         // ns
+      std::vector<double> distance;   // cm
+      std::vector<double> error;      // ns
+      std::vector<unsigned int> first;
+
+      /// number of muons
+      unsigned int size() const { return first.empty() ? 0 : first.size()-1; }
+      unsigned int numberOfMeasurements( unsigned int i ) const { return first[i+1]-first[i]; }
+      void clear() { t0.clear(); distance.clear(); error.clear(); first.clear(); }
+
+      /// append the measurements of one muon: its segments passing the
+      /// mask and with a measured t0 (segments without time have t0 = 0)
+      template<typename Distance>
+      void addMuon( const reco::Muon& muon, const Distance& distanceToIP,
+		    const MuonTimingParameters& parameters = MuonTimingParameters() )
+      {
+	 if ( first.empty() ) first.push_back(0);
+	 const std::vector<reco::MuonChamberMatch>& matches = muon.matches();
+	 for ( std::vector<reco::MuonChamberMatch>::const_iterator chamber = matches.begin();
+	       chamber != matches.end(); ++chamber ) {
+	    const int detector = chamber->detector();
+	    if ( detector != MuonSubdetId::DT && detector != MuonSubdetId::CSC ) continue;
+	    for ( std::vector<reco::MuonSegmentMatch>::const_iterator segment = chamber->segmentMatches.begin();
+		  segment != chamber->segmentMatches.end(); ++segment ) {
+	       if ( !segment->isMask(parameters.segmentMask) || segment->t0 == 0 ) continue;
+	       t0.push_back( segment->t0 );
+	       distance.push_back( distanceToIP(*chamber, *segment) );
+	       error.push_back( detector == MuonSubdetId::DT ? parameters.dtTimeError : parameters.cscTimeError );
+	    }
+	 }
+	 first.push_back( t0.size() );
+      }
+
+      /// replace the content by the measurements of all the muons of a collection
+      template<typename Distance>
+      void fill( const reco::MuonCollection& muons, const Distance& distanceToIP,
+		 const MuonTimingParameters& parameters = MuonTimingParameters() )
+      {
+	 clear();
+	 first.reserve( muons.size()+1 );
+	 first.push_back(0);
+	 for ( reco::MuonCollection::const_iterator muon = muons.begin(); muon != muons.end(); ++muon )
+	    addMuon( *muon, distanceToIP, parameters );
+      }
+   };
+
+   /// fit n measurements; with none, the result is the default MuonTime
+   reco::MuonTime fitMuonTime( const double* t0, const double* distance, const double* error, unsigned int n );
+
+   /// fit the measurements of muon i
+   inline reco::MuonTime fitMuonTime( const MuonTimeMeasurements& measurements, unsigned int i ) {
+      const unsigned int begin = measurements.first[i];
+      const unsigned int n = measurements.numberOfMeasurements(i);
+      if ( n == 0 ) return reco::MuonTime();
+      return fitMuonTime( &measurements.t0[begin], &measurements.distance[begin], &measurements.error[begin], n );
+   }
+
+   /// fit every muon, one result per muon
+   void fitMuonTimes( const MuonTimeMeasurements& measurements, std::vector<reco::MuonTime>& times );
+
+   /// fit one muon
+   template<typename Distance>
+   reco::MuonTime fitMuonTime( const reco::Muon& muon, const Distance& distanceToIP,
+				    const MuonTimingParameters& parameters = MuonTimingParameters() )
+   {
+      MuonTimeMeasurements measurements;
+      measurements.addMuon( muon, distanceToIP, parameters );
+      return fitMuonTime( measurements, 0 );
+   }
+}
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef MuonReco_MuonTrackTable_h
+#define MuonReco_MuonTrackTable_h
+
+/** \class muon::MuonTrackRow
+ *
+ *  The tracks of one muon, resolved once from their TrackRefs into
+ *  plain pointers, indexed by reco::Muon::MuonTrackType. A
+ *  muon::MuonTrackTable holds one row per muon of a collection, so
+ *  that selectors and cocktails run over a whole event without going
+ *  through the Ref product lookup again.
+ *
+ *  The pointers are only valid as long as the track collections they
+ *  point to, i.e. within the event the table was filled in.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include <vector>
+
+namespace muon {
+
+  struct MuonTrackRow {
+    enum { nTrackTypes = reco::Muon::DYT+1 };
+
+    /// tracks by MuonTrackType, null if the muon does not have it
+    /// (tracks[reco::Muon::None] is always null)
+    const reco::Track* tracks[nTrackTypes];
+    reco::Muon::MuonTrackType bestTrackType;
+    reco::Muon::MuonTrackType tunePBestTrackType;
+
+    const reco::Track* track( const reco::Muon::MuonTrackType type ) const {
+      return type > reco::Muon::None && int(type) < nTrackTypes ? tracks[type] : 0;
+    }
+    const reco::Track* innerTrack()  const { return tracks[reco::Muon::InnerTrack]; }
+    const reco::Track* outerTrack()  const { return tracks[reco::Muon::OuterTrack]; }
+    const reco::Track* globalTrack() const { return tracks[reco::Muon::CombinedTrack]; }
+    const reco::Track* tpfmsTrack()  const { return tracks[reco::Muon::TPFMS]; }
+    const reco::Track* pickyTrack()  const { return tracks[reco::Muon::Picky]; }
+    const reco::Track* dytTrack()    const { return tracks[reco::Muon::DYT]; }
+    /// same as reco::Muon::muonBestTrack() (and bestTrack())
+    const reco::Track* bestTrack()      const { return track(bestTrackType); }
+    /// same as reco::Muon::tunePMuonBestTrack()
+    const reco::Track* tunePBestTrack() const { return track(tunePBestTrackType); }
+  };
+
+  typedef std::vector<MuonTrackRow> MuonTrackTable;
+
+  /// resolve all the tracks of a muon
+  void fillMuonTrackRow( const reco::Muon& muon, MuonTrackRow& row );
+
+  /// resolve all the tracks of all the muons of a collection, one row per muon
+  void fillMuonTrackTable( const reco::MuonCollection& muons, MuonTrackTable& table );
+
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef MuonReco_MuonTruthMatch_h
+#define MuonReco_MuonTruthMatch_h
+
+/** \class reco::MuonChamberTruthMatch
+ *
+ *  Monte Carlo truth matching of a muon in one chamber: the SimHit
+ *  projections matching the propagated track trajectory. They used to
+ *  be stored in MuonChamberMatch::truthMatches; they are now kept in
+ *  a separate reco::MuonTruthMatchMap keyed by the muon, produced in
+ *  simulation jobs only, and looked up on request with
+ *  reco::Muon::truthMatches.
+ *
+ *  Files written before MuonChamberMatch version 12 keep their truth
+ *  matches: an ioread rule moves them to the transient
+ *  MuonChamberMatch::legacyTruthMatches, and Muon::truthMatches falls
+ *  back to them when no map is available for the muon. Jobs reprocessing
+ *  such files should write a MuonTruthMatchMap filled from
+ *  Muon::legacyTruthMatches() to carry the truth over.
+ *
+ */
+
+#include "DataFormats/Common/interface/ValueMap.h"
+#include "DataFormats/DetId/interface/DetId.h"
+#include "DataFormats/MuonReco/interface/MuonSegmentMatch.h"
+#include <vector>
+
+namespace reco {
+   class MuonChamberTruthMatch {
+      public:
+         DetId id;                                           // chamber ID, as in the MuonChamberMatch
+         std::vector<reco::MuonSegmentMatch> truthMatches;   // SimHit projection matching propagated track trajectory
+   };
+
+   /// the truth matches of one muon, one entry per chamber with truth matches
+   typedef std::vector<MuonChamberTruthMatch> MuonTruthMatches;
+   typedef edm::ValueMap<MuonTruthMatches> MuonTruthMatchMap;
+}
+
+#endif
@@ -0,0 +1,94 @@
+#ifndef MuonReco_SlimCaloMuon_h
+#define MuonReco_SlimCaloMuon_h
+
+/** \class reco::SlimCaloMuon
+ *
+ *  Compact storage of a reco::CaloMuon for the high-volume low-pT
+ *  collections. It keeps only what the calorimeter compatibility uses:
+ *  the em, had and ho energies and their 3x3 sums, as IEEE half floats
+ *  (relative precision 5e-4), the compatibility itself with a 1.5e-5
+ *  precision, and the key of the track. The track collection is stored
+ *  once for all the muons in reco::SlimCaloMuons.
+ *
+ *  Converting a CaloMuon drops the calorimeter positions, timing and
+ *  DetIds and rounds the stored quantities; converting back gives a
+ *  CaloMuon which converts again to the same SlimCaloMuon.
+ *
+ */
+
+#include "DataFormats/MuonReco/interface/CaloMuon.h"
+#include "DataFormats/TrackReco/interface/TrackFwd.h"
+#include <stdint.h>
+#include <vector>
+
+namespace reco {
+
+   class SlimCaloMuon {
+      public:
+	 SlimCaloMuon();
+	 /// the track key is the one of the CaloMuon track
+	 explicit SlimCaloMuon( const CaloMuon& muon );
+
+	 enum Energy { EM, EMS9, Had, HadS9, HO, HOS9, nEnergies };
+
+	 float em()    const { return energy(EM); }
+	 float emS9()  const { return energy(EMS9); }
+	 float had()   const { return energy(Had); }
+	 float hadS9() const { return energy(HadS9); }
+	 float ho()    const { return energy(HO); }
+	 float hoS9()  const { return energy(HOS9); }
+	 float energy( Energy energy ) const;
+	 /// MuonEnergy with the stored energies, the other fields being 0
+	 MuonEnergy calEnergy() const;
+
+	 bool isEnergyValid() const { return energyValid_; }
+	 bool isCaloCompatibilityValid() const { return caloCompatibility_ != invalidCompatibility; }
+	 /// -9999 when not valid, as in CaloMuon
+	 float caloCompatibility() const;
+
+	 bool hasTrack() const { return trackKey_ != noTrack; }
+	 unsigned int trackKey() const { return trackKey_; }
+
+	 /// the CaloMuon, with its track from the given collection
+	 CaloMuon caloMuon( const TrackRefProd& tracks ) const;
+
+      private:
+	 static const uint16_t invalidCompatibility = 0xffff;
+	 static const uint16_t compatibilityScale = 0xfffe;
+	 static const unsigned int noTrack = 0xffffffff;
+
+	 uint32_t trackKey_;
+	 uint16_t energies_[nEnergies];
+	 uint16_t caloCompatibility_;
+	 bool energyValid_;
+   };
+
+   /// the slim CaloMuons whose tracks all come from one collection
+   class SlimCaloMuons {
+      public:
+	 SlimCaloMuons() {}
+	 /// throws if the tracks of the muons come from different collections
+	 explicit SlimCaloMuons( const std::vector<CaloMuon>& muons );
+
+	 /// throws if the track is not from the collection of the others
+	 void push_back( const CaloMuon& muon );
+
+	 unsigned int size() const { return muons_.size(); }
+	 bool empty() const { return muons_.empty(); }
+	 const SlimCaloMuon& operator[]( unsigned int i ) const { return muons_[i]; }
+	 const std::vector<SlimCaloMuon>& muons() const { return muons_; }
+	 const TrackRefProd& tracks() const { return tracks_; }
+
+	 CaloMuon caloMuon( unsigned int i ) const { return muons_[i].caloMuon(tracks_); }
+	 /// the whole collection as CaloMuons
+	 void fill( std::vector<CaloMuon>& muons ) const;
+
+	 void swap( SlimCaloMuons& other );
+
+      private:
+	 TrackRefProd tracks_;
+	 std::vector<SlimCaloMuon> muons_;
+   };
+}
+
+#endif
@@ -4,5 +4,43 @@ using namespace reco;
 CaloMuon::CaloMuon() {
    energyValid_  = false;
    caloCompatibility_ = -9999.;
+   charge_ = 0;
 }
 
+void CaloMuon::setInnerTrack( const TrackRef & t )
+{
+   innerTrack_ = t;
+   refreshKinematics();
+}
+
+void CaloMuon::setKinematics( const Track* track )
+{
+   if ( track ) {
+      momentum_ = track->momentum();
+      charge_ = track->charge();
+   } else {
+      momentum_ = math::XYZVector();
+      charge_ = 0;
+   }
+}
+
+void muon::refreshKinematics( std::vector<reco::CaloMuon>& muons )
+{
+   // the availability and the collection are looked up once per product
+   edm::ProductID id;
+   const reco::TrackCollection* tracks = 0;
+   bool first = true;
+   for ( std::vector<reco::CaloMuon>::iterator muon = muons.begin(); muon != muons.end(); ++muon ) {
+      const reco::TrackRef& track = muon->innerTrack();
+      if ( track.isNull() ) {
+	 muon->setKinematics(0);
+	 continue;
+      }
+      if ( first || track.id() != id ) {
+	 first = false;
+	 id = track.id();
+	 tracks = track.isAvailable() ? track.product() : 0;
+      }
+      muon->setKinematics( tracks ? &(*tracks)[track.key()] : 0 );
+   }
+}
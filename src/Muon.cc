@@ -1,6 +1,8 @@
 #include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonRPCTiming.h"
 #include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
 #include "DataFormats/MuonDetId/interface/RPCDetId.h"
+#include <memory>
 
 using namespace reco;
 
@@ -45,10 +47,71 @@ Muon * Muon::clone() const {
   return new Muon( * this );
 }
 
+void Muon::packMatches( const muon::MuonMatchPrecision& precision ) {
+  unpackMatches();
+  matchBlock_.pack(muMatches_, precision);
+  std::vector<MuonChamberMatch>().swap(muMatches_);
+  unpackedMatches_.reset();
+}
+
+void Muon::doUnpackMatches() {
+  // the cache is copied, not moved: references returned by the const
+  // matches() before stay valid until the matches are set or packed again
+  if (unpackedMatches_.isSet()) muMatches_ = *unpackedMatches_;
+  else matchBlock_.unpack(muMatches_);
+  MuonMatchBlock().swap(matchBlock_);
+}
+
+const std::vector<MuonChamberMatch>& Muon::unpackedMatches() const {
+  if (!unpackedMatches_.isSet()) {
+    // concurrent callers may all unpack, only the first result is kept
+    std::unique_ptr<std::vector<MuonChamberMatch> > matches(new std::vector<MuonChamberMatch>);
+    matchBlock_.unpack(*matches);
+    unpackedMatches_.set(std::move(matches));
+  }
+  return *unpackedMatches_;
+}
+
+const MuonTruthMatches& Muon::truthMatches( const MuonTruthMatchMap& truth, const MuonRef& self ) const {
+  if (self.isNonnull() && truth.contains(self.id())) return truth[self];
+  return legacyTruthMatches();
+}
+
+const std::vector<MuonSegmentMatch>* Muon::truthMatches( const MuonTruthMatchMap& truth, const MuonRef& self,
+                                                         const DetId& chamber ) const {
+  const MuonTruthMatches& matches = truthMatches(truth, self);
+  for(MuonTruthMatches::const_iterator match = matches.begin(); match != matches.end(); ++match)
+    if (match->id == chamber) return &match->truthMatches;
+  return 0;
+}
+
+const MuonTruthMatches& Muon::legacyTruthMatches() const {
+  if (!legacyTruthMatches_.isSet()) {
+    // concurrent callers may all collect, only the first result is kept
+    std::unique_ptr<MuonTruthMatches> matches(new MuonTruthMatches);
+    for(std::vector<MuonChamberMatch>::const_iterator chamber = this->matches().begin();
+        chamber != this->matches().end(); ++chamber)
+      if (chamber->legacyTruthMatches) {
+        matches->push_back(MuonChamberTruthMatch());
+        matches->back().id = chamber->id;
+        matches->back().truthMatches = *chamber->legacyTruthMatches;
+      }
+    legacyTruthMatches_.set(std::move(matches));
+  }
+  return *legacyTruthMatches_;
+}
+
 int Muon::numberOfChambersNoRPC() const
 {
   int total = 0;
   int nAll = numberOfChambers();
+  if (!matchBlock_.empty()) {
+    // read in place, without unpacking
+    MuonMatchBlock::ChamberView chamber = matchBlock_.firstChamber();
+    for (int iC = 0; iC < nAll; ++iC, chamber = chamber.next())
+      if (chamber.detector() != MuonSubdetId::RPC) total++;
+    return total;
+  }
   for (int iC = 0; iC < nAll; ++iC){
     if (matches()[iC].detector() == MuonSubdetId::RPC) continue;
     total++;
@@ -60,8 +123,8 @@ int Muon::numberOfChambersNoRPC() const
 int Muon::numberOfMatches( ArbitrationType type ) const
 {
    int matches(0);
-   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-         chamberMatch != muMatches_.end(); chamberMatch++ )
+   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = this->matches().begin();
+         chamberMatch != this->matches().end(); chamberMatch++ )
    {
       if(type == RPCHitAndTrackArbitration) {
          if(chamberMatch->rpcMatches.empty()) continue;
@@ -125,8 +188,8 @@ unsigned int Muon::stationMask( ArbitrationType type ) const
    unsigned int totMask(0);
    unsigned int curMask(0);
 
-   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-         chamberMatch != muMatches_.end(); chamberMatch++ )
+   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+         chamberMatch != matches().end(); chamberMatch++ )
    {
       if(type == RPCHitAndTrackArbitration) {
 	 if(chamberMatch->rpcMatches.empty()) continue;
@@ -217,20 +280,12 @@ unsigned int Muon::RPClayerMask( ArbitrationType type ) const
 {
    unsigned int totMask(0);
    unsigned int curMask(0);
-   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-	 chamberMatch != muMatches_.end(); chamberMatch++ )
+   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+	 chamberMatch != matches().end(); chamberMatch++ )
    {
       if(chamberMatch->rpcMatches.empty()) continue;
 	 
-      RPCDetId rollId = chamberMatch->id.rawId();
-      const int region = rollId.region();
-
-      const int layer  = rollId.layer();
-      int rpcLayer = chamberMatch->station();
-      if (region==0) {
-	 rpcLayer = chamberMatch->station()-1 + chamberMatch->station()*layer;
-	 if ((chamberMatch->station()==2 && layer==2) || (chamberMatch->station()==4 && layer==1)) rpcLayer -= 1;
-      } else rpcLayer += 6;
+      const int rpcLayer = muon::rpcLayer(*chamberMatch);
 	 
       for( std::vector<MuonRPCHitMatch>::const_iterator rpcMatch = chamberMatch->rpcMatches.begin();
 	    rpcMatch != chamberMatch->rpcMatches.end(); rpcMatch++ )
@@ -255,8 +310,8 @@ unsigned int Muon::stationGapMaskDistance( float distanceCut ) const
       for( int detectorIndex = 1; detectorIndex < 4; detectorIndex++ )
       {
          unsigned int curMask(0);
-         for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-               chamberMatch != muMatches_.end(); chamberMatch++ )
+         for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+               chamberMatch != matches().end(); chamberMatch++ )
          {
             if(!(chamberMatch->station()==stationIndex && chamberMatch->detector()==detectorIndex)) continue;
 
@@ -288,8 +343,8 @@ unsigned int Muon::stationGapMaskPull( float sigmaCut ) const
       for( int detectorIndex = 1; detectorIndex < 4; detectorIndex++ )
       {
          unsigned int curMask(0);
-         for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-               chamberMatch != muMatches_.end(); chamberMatch++ )
+         for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+               chamberMatch != matches().end(); chamberMatch++ )
          {
             if(!(chamberMatch->station()==stationIndex && chamberMatch->detector()==detectorIndex)) continue;
 
@@ -318,8 +373,8 @@ unsigned int Muon::stationGapMaskPull( float sigmaCut ) const
 int Muon::numberOfSegments( int station, int muonSubdetId, ArbitrationType type ) const
 {
    int segments(0);
-   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-         chamberMatch != muMatches_.end(); chamberMatch++ )
+   for( std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+         chamberMatch != matches().end(); chamberMatch++ )
    {
       if(chamberMatch->segmentMatches.empty()) continue;
       if(!(chamberMatch->station()==station && chamberMatch->detector()==muonSubdetId)) continue;
@@ -364,8 +419,8 @@ int Muon::numberOfSegments( int station, int muonSubdetId, ArbitrationType type
 const std::vector<const MuonChamberMatch*> Muon::chambers( int station, int muonSubdetId ) const
 {
    std::vector<const MuonChamberMatch*> chambers;
-   for(std::vector<MuonChamberMatch>::const_iterator chamberMatch = muMatches_.begin();
-         chamberMatch != muMatches_.end(); chamberMatch++)
+   for(std::vector<MuonChamberMatch>::const_iterator chamberMatch = matches().begin();
+         chamberMatch != matches().end(); chamberMatch++)
       if(chamberMatch->station()==station && chamberMatch->detector()==muonSubdetId)
          chambers.push_back(&(*chamberMatch));
    return chambers;
@@ -812,25 +867,36 @@ void Muon::setIsolation( const MuonIsolation& isoR03, const MuonIsolation& isoR0
 
 void Muon::setPFIsolation(const std::string& label, const MuonPFIsolation& deposit) 
 { 
-  if(label=="pfIsolationR03")
-    pfIsolationR03_ = deposit;
-
-  if(label=="pfIsolationR04")
-    pfIsolationR04_ = deposit;
-
-  if(label=="pfIsoMeanDRProfileR03")
-    pfIsoMeanDRR03_ = deposit;
+  PFIsolationType type = pfIsolationType(label.c_str());
+  if (type != nPFIsolationTypes) setPFIsolation(type, deposit);
+  // as before, an unknown label sets no deposit but still flags the PF isolation valid
+  pfIsolationValid_ = true;
+}
 
-  if(label=="pfIsoMeanDRProfileR04")
-    pfIsoMeanDRR04_ = deposit;
+void Muon::setPFIsolation(PFIsolationType type, const MuonPFIsolation& deposit) 
+{ 
+  if (pfIsolations_.size() <= unsigned(type)) pfIsolations_.resize(type+1);
+  pfIsolations_[type] = deposit;
+  pfIsolationValid_ = true; 
+}
 
-  if(label=="pfIsoSumDRProfileR03")
-    pfIsoSumDRR03_ = deposit;
+void Muon::setPFIsolations(const MuonPFIsolation* deposits, unsigned int n) 
+{ 
+  if (n > nPFIsolationTypes) n = nPFIsolationTypes;
+  pfIsolations_.assign(deposits, deposits+n);
+  pfIsolationValid_ = true; 
+}
 
-  if(label=="pfIsoSumDRProfileR04")
-    pfIsoSumDRR04_ = deposit;
+const MuonPFIsolation& Muon::pfIsolation(PFIsolationType type) const
+{
+  static const MuonPFIsolation noIsolation;
+  return unsigned(type) < pfIsolations_.size() ? pfIsolations_[type] : noIsolation;
+}
 
-   pfIsolationValid_ = true; 
+void muon::setPFIsolations( std::vector<reco::Muon>& muons, const reco::MuonPFIsolation* deposits, unsigned int n )
+{
+  for ( std::vector<reco::Muon>::iterator muon = muons.begin(); muon != muons.end(); ++muon, deposits += n )
+    muon->setPFIsolations(deposits, n);
 }
 
 
@@ -0,0 +1,92 @@
+#include "DataFormats/MuonReco/interface/MuonAttachments.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "FWCore/Utilities/interface/Exception.h"
+using namespace reco;
+
+MuonAttachments::MuonAttachments( const MuonRefProd& muons, unsigned int blocks ):
+   muons_(muons), blocks_(blocks), size_(muons->size())
+{
+   if ( has(Quality) )             quality_.resize(size_);
+   if ( has(CosmicCompatibility) ) cosmicCompatibility_.resize(size_);
+   if ( has(Shower) )              shower_.resize(size_);
+   if ( has(METCorrection) )       metCorrection_.resize(size_);
+   if ( has(TimeCombined) )        timeCombined_.resize(size_);
+   if ( has(TimeDT) )              timeDT_.resize(size_);
+   if ( has(TimeCSC) )             timeCSC_.resize(size_);
+}
+
+unsigned int MuonAttachments::index( const MuonRef& muon ) const
+{
+   if ( muon.id() != muons_.id() || muon.key() >= size_ )
+      throw cms::Exception("MuonAttachments") << "muon " << muon.id() << ":" << muon.key()
+					      << " is not from the collection " << muons_.id();
+   return muon.key();
+}
+
+void MuonAttachments::swap( MuonAttachments& other )
+{
+   std::swap(muons_, other.muons_);
+   std::swap(blocks_, other.blocks_);
+   std::swap(size_, other.size_);
+   quality_.swap(other.quality_);
+   cosmicCompatibility_.swap(other.cosmicCompatibility_);
+   shower_.swap(other.shower_);
+   metCorrection_.swap(other.metCorrection_);
+   timeCombined_.swap(other.timeCombined_);
+   timeDT_.swap(other.timeDT_);
+   timeCSC_.swap(other.timeCSC_);
+}
+
+namespace {
+   // the values of the muons of a collection, contiguous in the map, or
+   // null if there is no map
+   template<typename T>
+   const T* mapValues( const edm::ValueMap<T>* map, const MuonRefProd& muons, const char* name )
+   {
+      if ( !map ) return 0;
+      if ( !map->contains(muons.id()) )
+	 throw cms::Exception("MuonAttachments") << "the " << name << " map has no entry for the muons " << muons.id();
+      return muons->empty() ? 0 : &(*map)[MuonRef(muons, 0)];
+   }
+}
+
+void muon::fillMuonAttachments( const reco::MuonRefProd& muons, const MuonAttachmentSources& sources,
+				reco::MuonAttachments& attachments )
+{
+   const reco::MuonQuality* quality =
+      mapValues(sources.quality, muons, "MuonQuality");
+   const reco::MuonCosmicCompatibility* cosmicCompatibility =
+      mapValues(sources.cosmicCompatibility, muons, "MuonCosmicCompatibility");
+   const reco::MuonShower* shower =
+      mapValues(sources.shower, muons, "MuonShower");
+   const reco::MuonMETCorrectionData* metCorrection =
+      mapValues(sources.metCorrection, muons, "MuonMETCorrectionData");
+   const reco::MuonTimeExtra* timeCombined =
+      mapValues(sources.timeExtraCombined, muons, "combined MuonTimeExtra");
+   const reco::MuonTimeExtra* timeDT =
+      mapValues(sources.timeExtraDT, muons, "DT MuonTimeExtra");
+   const reco::MuonTimeExtra* timeCSC =
+      mapValues(sources.timeExtraCSC, muons, "CSC MuonTimeExtra");
+
+   unsigned int blocks = 0;
+   if ( sources.quality )             blocks |= reco::MuonAttachments::Quality;
+   if ( sources.cosmicCompatibility ) blocks |= reco::MuonAttachments::CosmicCompatibility;
+   if ( sources.shower )              blocks |= reco::MuonAttachments::Shower;
+   if ( sources.metCorrection )       blocks |= reco::MuonAttachments::METCorrection;
+   if ( sources.timeExtraCombined )   blocks |= reco::MuonAttachments::TimeCombined;
+   if ( sources.timeExtraDT )         blocks |= reco::MuonAttachments::TimeDT;
+   if ( sources.timeExtraCSC )        blocks |= reco::MuonAttachments::TimeCSC;
+
+   // the ranges are resolved once above, so the pass is a plain copy
+   reco::MuonAttachments result(muons, blocks);
+   for ( unsigned int i = 0; i < result.size(); ++i ) {
+      if ( quality )             result.setQuality(i, quality[i]);
+      if ( cosmicCompatibility ) result.setCosmicCompatibility(i, cosmicCompatibility[i]);
+      if ( shower )              result.setShower(i, shower[i]);
+      if ( metCorrection )       result.setMETCorrection(i, metCorrection[i]);
+      if ( timeCombined )        result.setTimeCombined(i, reco::MuonTime(timeCombined[i]));
+      if ( timeDT )              result.setTimeDT(i, reco::MuonTime(timeDT[i]));
+      if ( timeCSC )             result.setTimeCSC(i, reco::MuonTime(timeCSC[i]));
+   }
+   attachments.swap(result);
+}
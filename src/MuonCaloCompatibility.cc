@@ -0,0 +1,210 @@
+#include "DataFormats/MuonReco/interface/MuonCaloCompatibility.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/CaloMuon.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <algorithm>
+
+using muon::CaloCompatibilityTemplates;
+
+namespace {
+   const float invalidCompatibility = -9999.;
+
+   // bin of a value, the values outside of the range going to the edge
+   // bins; NaN fails both comparisons and goes to the first bin, so that
+   // the conversion to unsigned int is always defined
+   inline unsigned int clampedBin( float value, float minimum, float binsPerUnit, unsigned int nBins )
+   {
+      const float bin = (value - minimum)*binsPerUnit;
+      const float last = float(nBins-1);
+      return (unsigned int)( bin > 0.f ? (bin < last ? bin : last) : 0.f );
+   }
+
+   // L_muon/(L_muon+L_pion), 0.5 when both vanish; written as arithmetic
+   // so that the division is not made conditional
+   inline float ratio( float muonLikelihood, float pionLikelihood )
+   {
+      const float sum = muonLikelihood + pionLikelihood;
+      const float none = sum > 0 ? 0.f : 1.f;
+      return (muonLikelihood + 0.5f*none)/(sum + none);
+   }
+}
+
+CaloCompatibilityTemplates::CaloCompatibilityTemplates( const std::vector<float>& etaEdges,
+							unsigned int nP, float pMin, float pMax,
+							unsigned int nEnergy, const float energyMax[nVariables],
+							bool useS9 ):
+  etaEdges_(etaEdges), nP_(nP), pMin_(pMin), nEnergy_(nEnergy), useS9_(useS9), minimumProbability_(0)
+{
+   if ( etaEdges_.size() < 2 || nP_ == 0 || nEnergy_ == 0 || !(pMax > pMin) )
+      throw cms::Exception("CaloCompatibilityTemplates") << "invalid binning: " << etaEdges_.size() << " eta edges, "
+							  << nP_ << " momentum bins in [" << pMin << ", " << pMax << "), "
+							  << nEnergy_ << " energy bins";
+   pBinsPerGeV_ = nP_/(pMax - pMin);
+   for ( int variable = 0; variable < nVariables; ++variable ) {
+      if ( !(energyMax[variable] > 0) )
+	 throw cms::Exception("CaloCompatibilityTemplates") << "invalid energy range " << energyMax[variable]
+							     << " for variable " << variable;
+      energyBinsPerGeV_[variable] = nEnergy_/energyMax[variable];
+   }
+   values_.resize( numberOfRegions()*nVariables*nP_*nEnergy_*nHypotheses, 0.f );
+}
+
+void CaloCompatibilityTemplates::setTemplate( Hypothesis hypothesis, Variable variable, unsigned int region, const float* values )
+{
+   if ( region >= numberOfRegions() )
+      throw cms::Exception("CaloCompatibilityTemplates") << "no region " << region << ", there are " << numberOfRegions();
+   float* bins = &values_[index(region, variable, 0, 0)] + hypothesis;
+   for ( unsigned int i = 0; i < nP_*nEnergy_; ++i )
+      bins[i*nHypotheses] = values[i];
+}
+
+unsigned int CaloCompatibilityTemplates::region( float eta ) const
+{
+   // the number of inner edges below eta
+   unsigned int region = 0;
+   for ( unsigned int edge = 1; edge+1 < etaEdges_.size(); ++edge )
+      region += eta >= etaEdges_[edge];
+   return region;
+}
+
+unsigned int CaloCompatibilityTemplates::pBin( float p ) const
+{
+   return clampedBin( p, pMin_, pBinsPerGeV_, nP_ );
+}
+
+unsigned int CaloCompatibilityTemplates::energyBin( Variable variable, float energy ) const
+{
+   return clampedBin( energy, 0.f, energyBinsPerGeV_[variable], nEnergy_ );
+}
+
+float CaloCompatibilityTemplates::energy( const reco::MuonEnergy& energy, Variable variable ) const
+{
+   switch ( variable ) {
+    case EM:  return useS9_ ? energy.emS9  : energy.em;
+    case Had: return useS9_ ? energy.hadS9 : energy.had;
+    case HO:  return useS9_ ? energy.hoS9  : energy.ho;
+    default:  return 0;
+   }
+}
+
+float CaloCompatibilityTemplates::probability( Hypothesis hypothesis, Variable variable, float p, float eta, float energy ) const
+{
+   const float value = values_[index(region(eta), variable, pBin(p), energyBin(variable, energy)) + hypothesis];
+   return std::max( value, minimumProbability_ );
+}
+
+float CaloCompatibilityTemplates::compatibility( float p, float eta, const float energies[nVariables] ) const
+{
+   float result;
+   const float* energy[nVariables] = { &energies[EM], &energies[Had], &energies[HO] };
+   compatibilities( &p, &eta, energy, 1, &result );
+   return result;
+}
+
+float CaloCompatibilityTemplates::compatibility( float p, float eta, const reco::MuonEnergy& energy ) const
+{
+   const float energies[nVariables] = { this->energy(energy, EM), this->energy(energy, Had), this->energy(energy, HO) };
+   return compatibility( p, eta, energies );
+}
+
+void CaloCompatibilityTemplates::compatibilities( const float* p, const float* eta, const float* const energies[nVariables],
+						  unsigned int n, float* result ) const
+{
+   const unsigned int blockSize = 64;
+   unsigned int bins[nVariables][blockSize];
+   float muonLikelihood[blockSize], pionLikelihood[blockSize];
+
+   const unsigned int nInnerEdges = etaEdges_.size()-2;
+   const float* innerEdges = &etaEdges_[1];
+   for ( unsigned int first = 0; first < n; first += blockSize ) {
+      const unsigned int size = std::min(blockSize, n-first);
+
+      // template offsets of the momentum bin and region, then of each variable
+      unsigned int offset[blockSize];
+      for ( unsigned int i = 0; i < size; ++i )
+	 offset[i] = clampedBin( p[first+i], pMin_, pBinsPerGeV_, nP_ );
+      for ( unsigned int edge = 0; edge < nInnerEdges; ++edge )
+	 for ( unsigned int i = 0; i < size; ++i )
+	    offset[i] += (eta[first+i] >= innerEdges[edge])*nVariables*nP_;
+      for ( int variable = 0; variable < nVariables; ++variable ) {
+	 const float* energy = energies[variable] + first;
+	 const float binsPerGeV = energyBinsPerGeV_[variable];
+	 for ( unsigned int i = 0; i < size; ++i )
+	    bins[variable][i] = ((offset[i] + variable*nP_)*nEnergy_ + clampedBin( energy[i], 0.f, binsPerGeV, nEnergy_ ))*nHypotheses;
+      }
+
+      // the template reads
+      for ( unsigned int i = 0; i < size; ++i ) {
+	 muonLikelihood[i] = pionLikelihood[i] = 1.f;
+	 for ( int variable = 0; variable < nVariables; ++variable ) {
+	    const float* bin = &values_[bins[variable][i]];
+	    muonLikelihood[i] *= std::max( bin[MuonHypothesis], minimumProbability_ );
+	    pionLikelihood[i] *= std::max( bin[PionHypothesis], minimumProbability_ );
+	 }
+      }
+
+      float* out = result + first;
+      for ( unsigned int i = 0; i < size; ++i )
+	 out[i] = ratio( muonLikelihood[i], pionLikelihood[i] );
+   }
+}
+
+namespace {
+   // gather the inputs of the muons with valid energy, evaluate them in
+   // one batch and scatter the results back
+   template<typename Muons>
+   void fill( const Muons& muons, const CaloCompatibilityTemplates& templates, std::vector<float>& compatibilities )
+   {
+      compatibilities.assign( muons.size(), invalidCompatibility );
+      std::vector<unsigned int> valid;
+      std::vector<float> p, eta, energies[CaloCompatibilityTemplates::nVariables];
+      valid.reserve( muons.size() );
+      for ( unsigned int i = 0; i < muons.size(); ++i ) {
+	 if ( !muons[i].isEnergyValid() ) continue;
+	 const reco::MuonEnergy& energy = muons[i].calEnergy();
+	 valid.push_back(i);
+	 p.push_back( muons[i].p() );
+	 eta.push_back( muons[i].eta() );
+	 for ( int variable = 0; variable < CaloCompatibilityTemplates::nVariables; ++variable )
+	    energies[variable].push_back( templates.energy(energy, CaloCompatibilityTemplates::Variable(variable)) );
+      }
+      if ( valid.empty() ) return;
+
+      std::vector<float> result( valid.size() );
+      const float* energy[CaloCompatibilityTemplates::nVariables] = { &energies[0][0], &energies[1][0], &energies[2][0] };
+      templates.compatibilities( &p[0], &eta[0], energy, valid.size(), &result[0] );
+      for ( unsigned int i = 0; i < valid.size(); ++i )
+	 compatibilities[valid[i]] = result[i];
+   }
+
+   template<typename Muons>
+   void set( Muons& muons, const CaloCompatibilityTemplates& templates )
+   {
+      std::vector<float> compatibilities;
+      fill( muons, templates, compatibilities );
+      for ( unsigned int i = 0; i < muons.size(); ++i )
+	 muons[i].setCaloCompatibility( compatibilities[i] );
+   }
+}
+
+void muon::fillCaloCompatibilities( const reco::MuonCollection& muons, const CaloCompatibilityTemplates& templates,
+				    std::vector<float>& compatibilities )
+{
+   fill( muons, templates, compatibilities );
+}
+
+void muon::fillCaloCompatibilities( const std::vector<reco::CaloMuon>& muons, const CaloCompatibilityTemplates& templates,
+				    std::vector<float>& compatibilities )
+{
+   fill( muons, templates, compatibilities );
+}
+
+void muon::setCaloCompatibilities( reco::MuonCollection& muons, const CaloCompatibilityTemplates& templates )
+{
+   set( muons, templates );
+}
+
+void muon::setCaloCompatibilities( std::vector<reco::CaloMuon>& muons, const CaloCompatibilityTemplates& templates )
+{
+   set( muons, templates );
+}
@@ -0,0 +1,164 @@
+#include "DataFormats/MuonReco/interface/MuonCleaning.h"
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
+#include "DataFormats/MuonDetId/interface/CSCDetId.h"
+#include <algorithm>
+#include <utility>
+#include <stdint.h>
+
+namespace {
+   // keys for chambers and for CSC rings must not collide: chamber keys are
+   // raw DetIds (detector bits 28-31 set to Muon), ring keys use bit 31 only
+   const unsigned int kRingKeyFlag = 1u<<31;
+
+   unsigned int cscRingKey( const DetId& id ) {
+      CSCDetId cscId(id);
+      return kRingKeyFlag | (cscId.endcap()<<8) | (cscId.station()<<4) | cscId.ring();
+   }
+}
+
+using namespace muon;
+
+class MuonGhostCleaner::RankOrder {
+public:
+   RankOrder( const MuonGhostCleaner& cleaner, const std::vector<RankingKey>& keys ) :
+      cleaner_(cleaner), keys_(keys) {}
+   bool operator()( unsigned int i, unsigned int j ) const {
+      return cleaner_.isBetter(keys_[i], keys_[j]);
+   }
+private:
+   const MuonGhostCleaner& cleaner_;
+   const std::vector<RankingKey>& keys_;
+};
+
+MuonGhostCleaner::MuonGhostCleaner( const GhostCleaningParameters& parameters ) :
+   parameters_(parameters)
+{}
+
+MuonGhostCleaner::RankingKey MuonGhostCleaner::rankingKey( const reco::Muon& muon ) const
+{
+   RankingKey key;
+   key.nPreferredTypes = 0;
+   for(unsigned int bits = muon.type() & parameters_.preferredTypes; bits; bits &= bits-1)
+      ++key.nPreferredTypes;
+   key.nMatches = muon.numberOfMatches(parameters_.arbitrationType);
+   key.pt = muon.pt();
+   return key;
+}
+
+bool MuonGhostCleaner::isBetter( const RankingKey& key1, const RankingKey& key2 ) const
+{
+   for(std::vector<GhostRankingCriterion>::const_iterator criterion = parameters_.ranking.begin();
+       criterion != parameters_.ranking.end(); ++criterion)
+   {
+      switch (*criterion) {
+      case RankByType:
+	 if (key1.nPreferredTypes != key2.nPreferredTypes) return key1.nPreferredTypes > key2.nPreferredTypes;
+	 break;
+      case RankByNumberOfMatches:
+	 if (key1.nMatches != key2.nMatches) return key1.nMatches > key2.nMatches;
+	 break;
+      case RankByPt:
+	 if (key1.pt != key2.pt) return key1.pt > key2.pt;
+	 break;
+      }
+   }
+   return false;
+}
+
+bool MuonGhostCleaner::isBetter( const reco::Muon& muon1, const reco::Muon& muon2 ) const
+{
+   return isBetter(rankingKey(muon1), rankingKey(muon2));
+}
+
+bool MuonGhostCleaner::areDuplicates( const reco::Muon& muon1, const reco::Muon& muon2 ) const
+{
+   if (parameters_.useOverlap &&
+       muon::overlap(muon1, muon2, parameters_.pullX, parameters_.pullY, parameters_.checkAdjacentChambers))
+      return true;
+   if (parameters_.useSharedSegments &&
+       muon::sharedSegments(muon1, muon2, parameters_.segmentArbitrationMask) >= parameters_.minSharedSegments)
+      return true;
+   return false;
+}
+
+void MuonGhostCleaner::clean( const reco::MuonCollection& muons, std::vector<int>& ghostOf ) const
+{
+   const unsigned int nMuons = muons.size();
+   ghostOf.assign(nMuons, -1);
+   if (nMuons < 2) return;
+
+   // Bucket the muons by the chambers they cross. Both overlap and
+   // sharedSegments need the two muons in the same chamber (or in
+   // neighbouring chambers of one CSC ring), so only pairs found in a
+   // common bucket can be related.
+   std::vector<std::pair<unsigned int, unsigned int> > buckets;
+   for(unsigned int i = 0; i < nMuons; ++i)
+      for(std::vector<reco::MuonChamberMatch>::const_iterator chamber = muons[i].matches().begin();
+	  chamber != muons[i].matches().end(); ++chamber)
+      {
+	 buckets.push_back(std::make_pair(chamber->id.rawId(), i));
+	 if (parameters_.useOverlap && parameters_.checkAdjacentChambers &&
+	     chamber->id.subdetId() == MuonSubdetId::CSC)
+	    buckets.push_back(std::make_pair(cscRingKey(chamber->id), i));
+      }
+   std::sort(buckets.begin(), buckets.end());
+   buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+
+   // the pairs sharing a bucket as (i<<32)|j, i < j, each tested once
+   // however many buckets it shares
+   std::vector<uint64_t> pairs;
+   for(std::vector<std::pair<unsigned int, unsigned int> >::const_iterator first = buckets.begin();
+       first != buckets.end(); )
+   {
+      std::vector<std::pair<unsigned int, unsigned int> >::const_iterator last = first;
+      while (last != buckets.end() && last->first == first->first) ++last;
+
+      for(std::vector<std::pair<unsigned int, unsigned int> >::const_iterator m1 = first; m1 != last; ++m1)
+	 for(std::vector<std::pair<unsigned int, unsigned int> >::const_iterator m2 = m1+1; m2 != last; ++m2)
+	    pairs.push_back((uint64_t(m1->second)<<32) | m2->second);
+      first = last;
+   }
+   std::sort(pairs.begin(), pairs.end());
+   pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+   // the duplicate pairs in both orders, sorted, so that the duplicates
+   // of a muon are one range
+   std::vector<std::pair<unsigned int, unsigned int> > duplicates;
+   for(std::vector<uint64_t>::const_iterator pair = pairs.begin(); pair != pairs.end(); ++pair) {
+      const unsigned int i = *pair>>32;
+      const unsigned int j = *pair & 0xffffffffu;
+      if (areDuplicates(muons[i], muons[j])) {
+	 duplicates.push_back(std::make_pair(i, j));
+	 duplicates.push_back(std::make_pair(j, i));
+      }
+   }
+   std::sort(duplicates.begin(), duplicates.end());
+
+   // rank once, then walk down the ranking: a muon survives unless it
+   // duplicates a better ranked survivor
+   std::vector<RankingKey> keys(nMuons);
+   std::vector<unsigned int> order(nMuons);
+   for(unsigned int i = 0; i < nMuons; ++i) {
+      keys[i] = rankingKey(muons[i]);
+      order[i] = i;
+   }
+   std::stable_sort(order.begin(), order.end(), RankOrder(*this, keys));
+
+   // rank[i] is the position of muon i in the ranking
+   std::vector<unsigned int> rank(nMuons);
+   for(unsigned int r = 0; r < nMuons; ++r) rank[order[r]] = r;
+
+   std::vector<char> survives(nMuons, 0);
+   for(std::vector<unsigned int>::const_iterator i = order.begin(); i != order.end(); ++i)
+   {
+      // the best ranked survivor among the duplicates of the muon
+      std::vector<std::pair<unsigned int, unsigned int> >::const_iterator duplicate =
+	 std::lower_bound(duplicates.begin(), duplicates.end(), std::make_pair(*i, 0u));
+      for(; duplicate != duplicates.end() && duplicate->first == *i; ++duplicate)
+	 if (survives[duplicate->second] &&
+	     (ghostOf[*i] < 0 || rank[duplicate->second] < rank[ghostOf[*i]]))
+	    ghostOf[*i] = duplicate->second;
+      if (ghostOf[*i] < 0) survives[*i] = 1;
+   }
+}
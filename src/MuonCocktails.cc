@@ -1,6 +1,197 @@
-#include "TMath.h"
 #include "DataFormats/MuonReco/interface/MuonCocktails.h"
+#include "DataFormats/MuonReco/interface/MuonTrackProbability.h"
 #include "DataFormats/TrackReco/interface/Track.h"
+#include <cmath>
+
+namespace {
+  // The TuneP decision, shared by the single muon and the collection
+  // versions of tevOptimized so that both give identical results. The
+  // inputs are given for the four refits in the order tracker,
+  // global, TPFMS, picky; prob is the log(tail probability) of the
+  // fit, which is only used if the fit has valid hits. Returns the
+  // index of the chosen refit.
+  int tunePChoice(const char valid[4],
+		  const char hasHits[4],
+		  const double pt[4],
+		  const double dpt[4],
+		  const double fitProb[4],
+		  const double ptThreshold,
+		  const double tune1,
+		  const double tune2,
+		  double dptcut) {
+
+    // Calculate the log(tail probabilities). If there's a problem,
+    // signify this with prob == 0. The current problems recognized are:
+    // the track being not available, whether the (re)fit failed or it's
+    // just not in the event, or if the (re)fit ended up with no valid
+    // hits.
+    double prob[4] = {0.,0.,0.,0.};
+
+    double dptmin = 1.;
+
+    if (dptcut>0) {  
+      for (unsigned int i = 0; i < 4; ++i)
+	if (valid[i])
+	  if (dpt[i]<dptmin) dptmin = dpt[i];
+  
+      if (dptmin>dptcut) dptcut = dptmin+0.15;
+    }
+
+    for (unsigned int i = 0; i < 4; ++i) 
+      if (valid[i] && hasHits[i] && (dpt[i]<dptcut || dptcut<0)) 
+	prob[i] = fitProb[i];
+
+    // Start with picky.
+    int chosen = 3;
+  
+    // If there's a problem with picky, make the default one of the
+    // other tracks. Try TPFMS first, then global, then tracker-only.
+    if (prob[3] == 0.) { 
+
+      // split so that passing dptcut<0 recreates EXACTLY the old tuneP behavior
+      if (dptcut>0) {
+	if      (prob[0] > 0.) chosen = 0;
+	else if (prob[2] > 0.) chosen = 2;
+	else if (prob[1] > 0.) chosen = 1;
+      } else {
+	if      (prob[2] > 0.) chosen = 2;
+	else if (prob[1] > 0.) chosen = 1;
+	else if (prob[0] > 0.) chosen = 0;
+      }
+    } 
+  
+    // Now the algorithm: switch from picky to tracker-only if the
+    // difference, log(tail prob(picky)) - log(tail prob(tracker-only))
+    // is greater than a tuned value. Then compare the
+    // so-picked track to TPFMS in the same manner using another tuned
+    // value.
+    if (prob[0] > 0. && prob[3] > 0. && (prob[3] - prob[0]) > tune1)
+      chosen = 0;
+    if (prob[2] > 0. && (prob[chosen] - prob[2]) > tune2)
+      chosen = 2;
+
+    // Sanity checks 
+    if (chosen == 3 && !valid[3] ) chosen = 2;
+    if (chosen == 2 && !valid[2] ) chosen = 1;
+    if (chosen == 1 && !valid[1] ) chosen = 0; 
+
+    // Done. If pT of the chosen track (or pT of the tracker track) is
+    // below the threshold value, return the tracker track. (prob[0] > 0
+    // implies that the tracker track is valid.)
+    if (valid[chosen] && pt[chosen] < ptThreshold && prob[0] > 0.) return 0;
+    if (prob[0] > 0. && pt[0] < ptThreshold) return 0;
+  
+    // Return the chosen track (which can be the global track in
+    // very rare cases).
+    return chosen;
+  }
+
+  const reco::Track* trackPointer(const reco::TrackRef& ref) {
+    return ref.isNonnull() ? &*ref : 0;
+  }
+
+  // Fill the i-th fit of the cocktail inputs; chi2 and ndof are left
+  // at 0 when the fit has no valid hits, so that its probability is 0.
+  void fillFit(const reco::Track* track,
+	       muon::MuonCocktailInputs& inputs,
+	       const unsigned int i,
+	       double& chi2,
+	       int& ndof) {
+    chi2 = 0.;
+    ndof = 0;
+    inputs.valid[i] = track != 0;
+    if (inputs.valid[i]) {
+      inputs.hasHits[i] = track->numberOfValidHits() > 0;
+      inputs.pt[i] = track->pt();
+      inputs.dptOverPt[i] = track->ptError()/inputs.pt[i];
+      if (inputs.hasHits[i]) {
+	chi2 = track->chi2();
+	ndof = (int)track->ndof();
+      }
+    } else {
+      inputs.hasHits[i] = false;
+      inputs.pt[i] = 0.;
+      inputs.dptOverPt[i] = 0.;
+    }
+  }
+
+  // Collection version: fits holds the tracker, global, TPFMS and
+  // picky fits of each muon in turn. The probabilities are computed
+  // over contiguous arrays.
+  void fillInputs(const std::vector<const reco::Track*>& fits,
+		  std::vector<muon::MuonCocktailInputs>& inputs) {
+    const unsigned int nFits = fits.size();
+    std::vector<double> chi2(nFits);
+    std::vector<int> ndof(nFits);
+    std::vector<double> prob(nFits);
+
+    inputs.resize(nFits/4);
+    for (unsigned int i = 0; i < nFits; ++i)
+      fillFit(fits[i], inputs[i/4], i%4, chi2[i], ndof[i]);
+
+    if (nFits > 0) muon::chi2LogTailProbabilities(&chi2[0], &ndof[0], &prob[0], nFits);
+
+    for (unsigned int i = 0; i < nFits; ++i)
+      inputs[i/4].prob[i%4] = prob[i];
+  }
+
+  // The sigma-switch decision: true if the global fit is chosen.
+  bool sigmaSwitchToGlobal(const reco::Track& combinedTrack,
+			   const reco::Track& trackerTrack,
+			   const double nSigma,
+			   const double ptThreshold) {
+    // If either the global or tracker-only fits have pT below threshold
+    // (default 200 GeV), return the tracker-only fit.
+    if (combinedTrack.pt() < ptThreshold || trackerTrack.pt() < ptThreshold)
+      return false;
+
+    // If both are above the pT threshold, compare the difference in
+    // q/p: if less than two sigma of the tracker-only track, switch to
+    // global. Otherwise, use tracker-only.
+    const double delta = fabs(trackerTrack.qoverp() - combinedTrack.qoverp());
+    const double threshold = nSigma * trackerTrack.qoverpError();
+    return delta <= threshold;
+  }
+
+  // The TMR decision, InnerTrack, TPFMS or None; the tracks may be null.
+  reco::Muon::MuonTrackType tmrChoice(const reco::Track* trackerTrack,
+				      const reco::Track* fmsTrack,
+				      const double tune) {
+    // tracker, TPFMS; tracks without valid hits keep chi2 = ndof = 0,
+    // which gives a probability of 0
+    double chi2[2] = {0.,0.};
+    int ndof[2] = {0,0};
+    double prob[2];
+
+    if (trackerTrack && trackerTrack->numberOfValidHits()) {
+      chi2[0] = trackerTrack->chi2();
+      ndof[0] = (int)trackerTrack->ndof();
+    }
+    if (fmsTrack && fmsTrack->numberOfValidHits()) {
+      chi2[1] = fmsTrack->chi2();
+      ndof[1] = (int)fmsTrack->ndof();
+    }
+    muon::chi2LogTailProbabilities(chi2, ndof, prob, 2);
+    const double probTK  = prob[0];
+    const double probFMS = prob[1];
+
+    bool TKok  = probTK > 0;
+    bool FMSok = probFMS > 0;
+
+    if (TKok && FMSok) {
+      if (probFMS - probTK > tune)
+	return reco::Muon::InnerTrack;
+      else
+	return reco::Muon::TPFMS;
+    }
+    else if (FMSok)
+      return reco::Muon::TPFMS;
+    else if (TKok)
+      return reco::Muon::InnerTrack;
+    else
+      return reco::Muon::None;
+  }
+}
 
 //
 // Return the TeV-optimized refit track (aka the cocktail or Tune P) or
@@ -13,7 +204,7 @@ reco::Muon::MuonTrackTypePair  muon::tevOptimized(const reco::TrackRef& combined
 						  const double ptThreshold,
 						  const double tune1,
 						  const double tune2,
-						  double dptcut) {
+						  const double dptcut) {
 
   // Array for convenience below.
   const reco::Muon::MuonTrackTypePair refit[4] = { 
@@ -23,73 +214,175 @@ reco::Muon::MuonTrackTypePair  muon::tevOptimized(const reco::TrackRef& combined
     make_pair(pickyTrack,   reco::Muon::Picky)
   }; 
   
-  // Calculate the log(tail probabilities). If there's a problem,
-  // signify this with prob == 0. The current problems recognized are:
-  // the track being not available, whether the (re)fit failed or it's
-  // just not in the event, or if the (re)fit ended up with no valid
-  // hits.
-  double prob[4] = {0.,0.,0.,0.};
-  bool valid[4] = {0,0,0,0};
+  MuonCocktailInputs inputs;
+  fillCocktailInputs(combinedTrack, trackerTrack, tpfmsTrack, pickyTrack, inputs);
+
+  return refit[tevOptimizedChoice(inputs, ptThreshold, tune1, tune2, dptcut)];
+}
+
+void muon::tevOptimized(const reco::MuonCollection& muons,
+			std::vector<reco::Muon::MuonTrackTypePair>& result,
+			const double ptThreshold,
+			const double tune1,
+			const double tune2,
+			const double dptcut) {
 
-  double dptmin = 1.;
+  std::vector<MuonCocktailInputs> inputs;
+  fillCocktailInputs(muons, inputs);
+
+  result.resize(muons.size());
+  for (unsigned int iMuon = 0; iMuon < muons.size(); ++iMuon) {
+    const reco::Muon::MuonTrackType type = cocktailTrackType(tevOptimizedChoice(inputs[iMuon], ptThreshold, tune1, tune2, dptcut));
+    result[iMuon] = make_pair(muons[iMuon].muonTrack(type), type);
+  }
+}
+
+reco::Muon::MuonTrackType muon::tevOptimizedType(const MuonTrackRow& tracks,
+						 const double ptThreshold,
+						 const double tune1,
+						 const double tune2,
+						 const double dptcut) {
+  MuonCocktailInputs inputs;
+  fillCocktailInputs(tracks, inputs);
+  return cocktailTrackType(tevOptimizedChoice(inputs, ptThreshold, tune1, tune2, dptcut));
+}
+
+void muon::tevOptimizedTypes(const MuonTrackTable& table,
+			     std::vector<reco::Muon::MuonTrackType>& result,
+			     const double ptThreshold,
+			     const double tune1,
+			     const double tune2,
+			     const double dptcut) {
+  std::vector<MuonCocktailInputs> inputs;
+  fillCocktailInputs(table, inputs);
+
+  result.resize(table.size());
+  for (unsigned int iMuon = 0; iMuon < table.size(); ++iMuon)
+    result[iMuon] = cocktailTrackType(tevOptimizedChoice(inputs[iMuon], ptThreshold, tune1, tune2, dptcut));
+}
+
+//
+// Extract the inputs of the TuneP decision
+//
+void muon::fillCocktailInputs(const reco::TrackRef& combinedTrack,
+			      const reco::TrackRef& trackerTrack,
+			      const reco::TrackRef& tpfmsTrack,
+			      const reco::TrackRef& pickyTrack,
+			      MuonCocktailInputs& inputs) {
 
-  if (dptcut>0) {  
+  const reco::Track* refit[4] = {
+    trackPointer(trackerTrack),
+    trackPointer(combinedTrack),
+    trackPointer(tpfmsTrack),
+    trackPointer(pickyTrack)
+  };
+  double chi2[4];
+  int ndof[4];
+
+  for (unsigned int i = 0; i < 4; ++i)
+    fillFit(refit[i], inputs, i, chi2[i], ndof[i]);
+
+  muon::chi2LogTailProbabilities(chi2, ndof, inputs.prob, 4);
+}
+
+void muon::fillCocktailInputs(const MuonTrackRow& tracks,
+			      MuonCocktailInputs& inputs) {
+
+  double chi2[4];
+  int ndof[4];
+
+  for (unsigned int i = 0; i < 4; ++i)
+    fillFit(tracks.track(cocktailTrackType(i)), inputs, i, chi2[i], ndof[i]);
+
+  muon::chi2LogTailProbabilities(chi2, ndof, inputs.prob, 4);
+}
+
+void muon::fillCocktailInputs(const reco::MuonCollection& muons,
+			      std::vector<MuonCocktailInputs>& inputs) {
+
+  // One pass over the muons, dereferencing each refit once.
+  std::vector<const reco::Track*> fits(4*muons.size());
+  for (unsigned int iMuon = 0; iMuon < muons.size(); ++iMuon) {
+    const reco::Muon& muon = muons[iMuon];
+    fits[4*iMuon+0] = trackPointer(muon.innerTrack());
+    fits[4*iMuon+1] = trackPointer(muon.globalTrack());
+    fits[4*iMuon+2] = trackPointer(muon.tpfmsTrack());
+    fits[4*iMuon+3] = trackPointer(muon.pickyTrack());
+  }
+  fillInputs(fits, inputs);
+}
+
+void muon::fillCocktailInputs(const MuonTrackTable& table,
+			      std::vector<MuonCocktailInputs>& inputs) {
+
+  std::vector<const reco::Track*> fits(4*table.size());
+  for (unsigned int iMuon = 0; iMuon < table.size(); ++iMuon)
     for (unsigned int i = 0; i < 4; ++i)
-      if (refit[i].first.isNonnull())
-        if (refit[i].first->ptError()/refit[i].first->pt()<dptmin) dptmin = refit[i].first->ptError()/refit[i].first->pt();
-  
-    if (dptmin>dptcut) dptcut = dptmin+0.15;
+      fits[4*iMuon+i] = table[iMuon].track(cocktailTrackType(i));
+  fillInputs(fits, inputs);
+}
+
+int muon::tevOptimizedChoice(const MuonCocktailInputs& inputs,
+			     const double ptThreshold,
+			     const double tune1,
+			     const double tune2,
+			     const double dptcut) {
+  return tunePChoice(inputs.valid, inputs.hasHits, inputs.pt, inputs.dptOverPt, inputs.prob,
+		     ptThreshold, tune1, tune2, dptcut);
+}
+
+//
+// TuneP parameter scans
+//
+std::vector<muon::TunePParameters> muon::tunePGrid(const std::vector<double>& ptThresholds,
+						   const std::vector<double>& tune1s,
+						   const std::vector<double>& tune2s,
+						   const std::vector<double>& dptcuts) {
+  std::vector<TunePParameters> grid;
+  grid.reserve(ptThresholds.size()*tune1s.size()*tune2s.size()*dptcuts.size());
+  for (unsigned int i = 0; i < ptThresholds.size(); ++i)
+    for (unsigned int j = 0; j < tune1s.size(); ++j)
+      for (unsigned int k = 0; k < tune2s.size(); ++k)
+	for (unsigned int l = 0; l < dptcuts.size(); ++l)
+	  grid.push_back(TunePParameters(ptThresholds[i], tune1s[j], tune2s[k], dptcuts[l]));
+  return grid;
+}
+
+void muon::tevOptimizedChoices(const std::vector<MuonCocktailInputs>& inputs,
+			       const std::vector<TunePParameters>& grid,
+			       std::vector<unsigned char>& choices) {
+  tevOptimizedChoices(inputs.empty() ? 0 : &inputs[0], inputs.size(), grid, choices);
+}
+
+void muon::tevOptimizedChoices(const MuonCocktailInputs* inputs,
+			       const unsigned int nMuons,
+			       const std::vector<TunePParameters>& grid,
+			       std::vector<unsigned char>& choices) {
+  choices.resize(grid.size()*nMuons);
+  for (unsigned int iPoint = 0; iPoint < grid.size(); ++iPoint) {
+    const TunePParameters& par = grid[iPoint];
+    unsigned char* choice = nMuons > 0 ? &choices[iPoint*nMuons] : 0;
+    for (unsigned int iMuon = 0; iMuon < nMuons; ++iMuon)
+      choice[iMuon] = tevOptimizedChoice(inputs[iMuon], par.ptThreshold, par.tune1, par.tune2, par.dptcut);
   }
+}
 
-  for (unsigned int i = 0; i < 4; ++i) 
-    if (refit[i].first.isNonnull()){ 
-      valid[i] = true;
-      if (refit[i].first->numberOfValidHits() && (refit[i].first->ptError()/refit[i].first->pt()<dptcut || dptcut<0)) 
-	prob[i] = muon::trackProbability(refit[i].first); 
-    }
+void muon::tevOptimizedChoiceCounts(const std::vector<MuonCocktailInputs>& inputs,
+				    const std::vector<TunePParameters>& grid,
+				    std::vector<unsigned int>& counts) {
+  tevOptimizedChoiceCounts(inputs.empty() ? 0 : &inputs[0], inputs.size(), grid, counts);
+}
 
-  
-  // Start with picky.
-  int chosen = 3;
-  
-  // If there's a problem with picky, make the default one of the
-  // other tracks. Try TPFMS first, then global, then tracker-only.
-  if (prob[3] == 0.) { 
-
-    // split so that passing dptcut<0 recreates EXACTLY the old tuneP behavior
-    if (dptcut>0) {
-      if      (prob[0] > 0.) chosen = 0;
-      else if (prob[2] > 0.) chosen = 2;
-      else if (prob[1] > 0.) chosen = 1;
-    } else {
-      if      (prob[2] > 0.) chosen = 2;
-      else if (prob[1] > 0.) chosen = 1;
-      else if (prob[0] > 0.) chosen = 0;
-    }
-  } 
-  
-  // Now the algorithm: switch from picky to tracker-only if the
-  // difference, log(tail prob(picky)) - log(tail prob(tracker-only))
-  // is greater than a tuned value. Then compare the
-  // so-picked track to TPFMS in the same manner using another tuned
-  // value.
-  if (prob[0] > 0. && prob[3] > 0. && (prob[3] - prob[0]) > tune1)
-    chosen = 0;
-  if (prob[2] > 0. && (prob[chosen] - prob[2]) > tune2)
-    chosen = 2;
-
-  // Sanity checks 
-  if (chosen == 3 && !valid[3] ) chosen = 2;
-  if (chosen == 2 && !valid[2] ) chosen = 1;
-  if (chosen == 1 && !valid[1] ) chosen = 0; 
-
-  // Done. If pT of the chosen track (or pT of the tracker track) is below the threshold value, return the tracker track.
-  if (valid[chosen] && refit[chosen].first->pt() < ptThreshold && prob[0] > 0.) return make_pair(trackerTrack,reco::Muon::InnerTrack);    
-  if (trackerTrack->pt() < ptThreshold && prob[0] > 0.) return make_pair(trackerTrack,reco::Muon::InnerTrack);  
-  
-  // Return the chosen track (which can be the global track in
-  // very rare cases).
-  return refit[chosen];
+void muon::tevOptimizedChoiceCounts(const MuonCocktailInputs* inputs,
+				    const unsigned int nMuons,
+				    const std::vector<TunePParameters>& grid,
+				    std::vector<unsigned int>& counts) {
+  counts.assign(4*grid.size(), 0);
+  for (unsigned int iPoint = 0; iPoint < grid.size(); ++iPoint) {
+    const TunePParameters& par = grid[iPoint];
+    for (unsigned int iMuon = 0; iMuon < nMuons; ++iMuon)
+      ++counts[4*iPoint + tevOptimizedChoice(inputs[iMuon], par.ptThreshold, par.tune1, par.tune2, par.dptcut)];
+  }
 }
 
 //
@@ -97,15 +390,16 @@ reco::Muon::MuonTrackTypePair  muon::tevOptimized(const reco::TrackRef& combined
 //
 double muon::trackProbability(const reco::TrackRef track) {
   
-  int nDOF = (int)track->ndof();
-  if ( nDOF > 0 && track->chi2()> 0) { 
-    return -log(TMath::Prob(track->chi2(), nDOF));
-  } else { 
-    return 0.0;
-  }
+  return muon::trackProbability(track->chi2(), (int)track->ndof());
   
 }
 
+double muon::trackProbability(const double chi2, const int ndof) {
+
+  return muon::chi2LogTailProbability(chi2, ndof);
+
+}
+
 reco::TrackRef muon::getTevRefitTrack(const reco::TrackRef& combinedTrack,
 						     const reco::TrackToTrackMap& map) {
   reco::TrackToTrackMap::const_iterator it = map.find(combinedTrack);
@@ -120,17 +414,16 @@ reco::Muon::MuonTrackTypePair muon::sigmaSwitch(const reco::TrackRef& combinedTr
 						const reco::TrackRef& trackerTrack,
 						const double nSigma,
 						const double ptThreshold) {
-  // If either the global or tracker-only fits have pT below threshold
-  // (default 200 GeV), return the tracker-only fit.
-  if (combinedTrack->pt() < ptThreshold || trackerTrack->pt() < ptThreshold)
-    return make_pair(trackerTrack,reco::Muon::InnerTrack);
-  
-  // If both are above the pT threshold, compare the difference in
-  // q/p: if less than two sigma of the tracker-only track, switch to
-  // global. Otherwise, use tracker-only.
-  const double delta = fabs(trackerTrack->qoverp() - combinedTrack->qoverp());
-  const double threshold = nSigma * trackerTrack->qoverpError();
-  return delta > threshold ? make_pair(trackerTrack,reco::Muon::InnerTrack) :  make_pair(combinedTrack,reco::Muon::CombinedTrack);
+  return sigmaSwitchToGlobal(*combinedTrack, *trackerTrack, nSigma, ptThreshold) ?
+    make_pair(combinedTrack,reco::Muon::CombinedTrack) : make_pair(trackerTrack,reco::Muon::InnerTrack);
+}
+
+reco::Muon::MuonTrackType muon::sigmaSwitchType(const MuonTrackRow& tracks,
+						const double nSigma,
+						const double ptThreshold) {
+  if (!tracks.globalTrack() || !tracks.innerTrack()) return reco::Muon::None;
+  return sigmaSwitchToGlobal(*tracks.globalTrack(), *tracks.innerTrack(), nSigma, ptThreshold) ?
+    reco::Muon::CombinedTrack : reco::Muon::InnerTrack;
 }
 
 //
@@ -139,27 +432,14 @@ reco::Muon::MuonTrackTypePair muon::sigmaSwitch(const reco::TrackRef& combinedTr
 reco::Muon::MuonTrackTypePair muon::TMR(const reco::TrackRef& trackerTrack,
 					const reco::TrackRef& fmsTrack,
 					const double tune) {
-  double probTK  = 0;
-  double probFMS = 0;
-  
-  if (trackerTrack.isNonnull() && trackerTrack->numberOfValidHits())  
-    probTK = muon::trackProbability(trackerTrack);
-  if (fmsTrack.isNonnull() && fmsTrack->numberOfValidHits())
-    probFMS = muon::trackProbability(fmsTrack);
-  
-  bool TKok  = probTK > 0;
-  bool FMSok = probFMS > 0;
-  
-  if (TKok && FMSok) {
-    if (probFMS - probTK > tune)
-      return make_pair(trackerTrack,reco::Muon::InnerTrack);
-    else
-      return  make_pair(fmsTrack,reco::Muon::TPFMS);
+  switch (tmrChoice(trackPointer(trackerTrack), trackPointer(fmsTrack), tune)) {
+  case reco::Muon::InnerTrack: return make_pair(trackerTrack,reco::Muon::InnerTrack);
+  case reco::Muon::TPFMS:      return make_pair(fmsTrack,reco::Muon::TPFMS);
+  default:                     return make_pair(reco::TrackRef(),reco::Muon::None);
   }
-  else if (FMSok)
-    return  make_pair(fmsTrack,reco::Muon::TPFMS);
-  else if (TKok)
-    return make_pair(trackerTrack,reco::Muon::InnerTrack);
-  else
-    return make_pair(reco::TrackRef(),reco::Muon::None); 
+}
+
+reco::Muon::MuonTrackType muon::TMRType(const MuonTrackRow& tracks,
+					const double tune) {
+  return tmrChoice(tracks.innerTrack(), tracks.tpfmsTrack(), tune);
 }
@@ -0,0 +1,411 @@
+#include "DataFormats/MuonReco/interface/MuonMatchBlock.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <stdint.h>
+using namespace reco;
+
+namespace {
+   // the format word holds the version in its low byte, then the
+   // number of mantissa bits of positions, slopes and errors
+   const unsigned int formatVersion = 2;
+   const int precisionBits = 5;
+
+   unsigned int formatWord( const muon::MuonMatchPrecision& precision ) {
+      return formatVersion | precision.positionBits<<8 | precision.slopeBits<<(8+precisionBits)
+	 | precision.errorBits<<(8+2*precisionBits);
+   }
+
+   muon::MuonMatchPrecision checkedPrecision( unsigned int format ) {
+      if ( (format & 0xff) != formatVersion )
+	 throw cms::Exception("MuonMatchBlock") << "unknown match buffer format " << (format & 0xff);
+      const unsigned int mask = (1u<<precisionBits) - 1;
+      return muon::MuonMatchPrecision(format>>8 & mask, format>>(8+precisionBits) & mask,
+				      format>>(8+2*precisionBits) & mask);
+   }
+
+   void checkPrecision( const muon::MuonMatchPrecision& precision ) {
+      if ( precision.positionBits < 0 || precision.positionBits > 23 || precision.slopeBits < 0 || precision.slopeBits > 23 ||
+	   precision.errorBits < 0 || precision.errorBits > 23 )
+	 throw cms::Exception("MuonMatchBlock") << "mantissa bits must be between 0 and 23, got " << precision.positionBits
+						<< "/" << precision.slopeBits << "/" << precision.errorBits;
+   }
+   // segment and RPC hit counts of a chamber, segment keys
+   const int countBits = 16;
+   const int keyBits = 30;
+
+   class BitWriter {
+      public:
+	 explicit BitWriter( std::vector<unsigned int>& words ) : words_(words), buffer_(0), nBits_(0) {}
+
+	 /// append the low bits of value, 1 <= bits <= 32
+	 void put( uint32_t value, int bits ) {
+	    buffer_ |= uint64_t(value) << nBits_;
+	    nBits_ += bits;
+	    if ( nBits_ >= 32 ) {
+	       words_.push_back(uint32_t(buffer_));
+	       buffer_ >>= 32;
+	       nBits_ -= 32;
+	    }
+	 }
+	 /// the sign, the exponent and the top bits of the mantissa of the
+	 /// value rounded to nearest; zero, infinities, NaN and the "not
+	 /// available" sentinels (|value| >= 9e5) are escaped and kept exactly
+	 void putFloat( float value, int bits ) {
+	    uint32_t word;
+	    const float rounded = muon::reduceMantissa(value, bits);
+	    std::memcpy(&word, &rounded, sizeof(word));
+	    if ( bits >= 23 ) {
+	       put(word, 32);
+	    } else if ( (word & 0x7f800000u) == 0x7f800000u || rounded >= 9e5f || rounded <= -9e5f ) {
+	       put((word>>31)<<(8+bits) | 0xffu<<bits, 9+bits);
+	       put(word, 32);
+	    } else {
+	       put(word>>(23-bits), 9+bits);
+	    }
+	 }
+	 void flush() {
+	    if ( nBits_ > 0 ) words_.push_back(uint32_t(buffer_));
+	    buffer_ = 0;
+	    nBits_ = 0;
+	 }
+
+      private:
+	 std::vector<unsigned int>& words_;
+	 uint64_t buffer_;
+	 int nBits_;
+   };
+
+   class BitReader {
+      public:
+	 BitReader( const unsigned int* begin, const unsigned int* end ) : next_(begin), end_(end), buffer_(0), nBits_(0) {}
+
+	 uint32_t get( int bits ) {
+	    if ( nBits_ < bits ) {
+	       if ( next_ == end_ ) throw cms::Exception("MuonMatchBlock") << "the match buffer is truncated";
+	       buffer_ |= uint64_t(*next_++) << nBits_;
+	       nBits_ += 32;
+	    }
+	    const uint32_t value = uint32_t(buffer_ & ((uint64_t(1)<<bits) - 1));
+	    buffer_ >>= bits;
+	    nBits_ -= bits;
+	    return value;
+	 }
+	 float getFloat( int bits ) {
+	    uint32_t word;
+	    if ( bits >= 23 ) {
+	       word = get(32);
+	    } else {
+	       word = get(9+bits);
+	       word = (word>>bits & 0xffu) == 0xffu ? get(32) : word<<(23-bits);
+	    }
+	    float value;
+	    std::memcpy(&value, &word, sizeof(value));
+	    return value;
+	 }
+
+      private:
+	 const unsigned int* next_;
+	 const unsigned int* end_;
+	 uint64_t buffer_;
+	 int nBits_;
+   };
+
+   uint32_t checkedCount( unsigned int count, const char* what ) {
+      if ( count >> countBits )
+	 throw cms::Exception("MuonMatchBlock") << count << " " << what << " in one chamber, at most "
+						<< (1u<<countBits) - 1 << " can be stored";
+      return count;
+   }
+
+   class Encoder {
+      public:
+	 Encoder( std::vector<unsigned int>& words, const muon::MuonMatchPrecision& precision,
+		  edm::RefCore& dtSegments, edm::RefCore& cscSegments ) :
+	    writer_(words), precision_(precision), dtSegments_(dtSegments), cscSegments_(cscSegments) {}
+
+	 /// MuonChamberMatch and ChamberRecord share the names of the fields
+	 template<class Chamber>
+	 void putChamber( const Chamber& chamber, unsigned int rawId, unsigned int nSegmentMatches, unsigned int nRPCMatches ) {
+	    writer_.put(rawId, 32);
+	    writer_.put(checkedCount(nSegmentMatches, "segment matches"), countBits);
+	    writer_.put(checkedCount(nRPCMatches, "RPC hit matches"), countBits);
+	    writer_.putFloat(chamber.edgeX, precision_.positionBits);
+	    writer_.putFloat(chamber.edgeY, precision_.positionBits);
+	    writer_.putFloat(chamber.x, precision_.positionBits);
+	    writer_.putFloat(chamber.y, precision_.positionBits);
+	    writer_.putFloat(chamber.xErr, precision_.errorBits);
+	    writer_.putFloat(chamber.yErr, precision_.errorBits);
+	    writer_.putFloat(chamber.dXdZ, precision_.slopeBits);
+	    writer_.putFloat(chamber.dYdZ, precision_.slopeBits);
+	    writer_.putFloat(chamber.dXdZErr, precision_.errorBits);
+	    writer_.putFloat(chamber.dYdZErr, precision_.errorBits);
+	 }
+
+	 void putSegment( const MuonSegmentMatch& segment ) {
+	    writer_.putFloat(segment.x, precision_.positionBits);
+	    writer_.putFloat(segment.y, precision_.positionBits);
+	    writer_.putFloat(segment.xErr, precision_.errorBits);
+	    writer_.putFloat(segment.yErr, precision_.errorBits);
+	    writer_.putFloat(segment.dXdZ, precision_.slopeBits);
+	    writer_.putFloat(segment.dYdZ, precision_.slopeBits);
+	    writer_.putFloat(segment.dXdZErr, precision_.errorBits);
+	    writer_.putFloat(segment.dYdZErr, precision_.errorBits);
+	    writer_.putFloat(segment.t0, precision_.positionBits);
+	    writer_.put(segment.mask, 32);
+	    writer_.put(segment.hasZed_ ? 1 : 0, 1);
+	    writer_.put(segment.hasPhi_ ? 1 : 0, 1);
+	    writer_.put(segment.segmentType(), 2);
+	    if ( segment.segmentType() == MuonSegmentMatch::DTSegment ) {
+	       const DTRecSegment4DRef ref = segment.dtSegmentRef();
+	       putSegmentKey(dtSegments_, ref.refCore(), ref.key(), "DT");
+	    } else if ( segment.segmentType() == MuonSegmentMatch::CSCSegment ) {
+	       const CSCSegmentRef ref = segment.cscSegmentRef();
+	       putSegmentKey(cscSegments_, ref.refCore(), ref.key(), "CSC");
+	    }
+	 }
+
+	 void putRPCHit( const MuonRPCHitMatch& hit ) {
+	    writer_.putFloat(hit.x, precision_.positionBits);
+	    writer_.put(hit.mask, 32);
+	    writer_.put(uint32_t(hit.bx), 32);
+	 }
+
+	 void flush() { writer_.flush(); }
+
+      private:
+	 /// the segment product of each type is stored once, the segments keep their key
+	 void putSegmentKey( edm::RefCore& products, const edm::RefCore& product, unsigned int key, const char* type ) {
+	    if ( products.isNull() ) products = product;
+	    else if ( products.id() != product.id() )
+	       throw cms::Exception("MuonMatchBlock") << "the segment matches of a muon refer to two " << type
+						      << " segment collections, " << products.id() << " and " << product.id();
+	    writer_.put(key, keyBits);
+	 }
+
+	 BitWriter writer_;
+	 muon::MuonMatchPrecision precision_;
+	 edm::RefCore& dtSegments_;
+	 edm::RefCore& cscSegments_;
+   };
+
+   class Decoder {
+      public:
+	 Decoder( const std::vector<unsigned int>& words, unsigned int headerSize, const muon::MuonMatchPrecision& precision,
+		  const edm::RefCore& dtSegments, const edm::RefCore& cscSegments ) :
+	    reader_(&words[0] + headerSize, &words[0] + words.size()), precision_(precision),
+	    dtSegments_(dtSegments), cscSegments_(cscSegments) {}
+
+	 void getChamber( MuonMatchBlock::ChamberRecord& record ) {
+	    record.rawId           = reader_.get(32);
+	    record.nSegmentMatches = reader_.get(countBits);
+	    record.nRPCMatches     = reader_.get(countBits);
+	    record.edgeX   = reader_.getFloat(precision_.positionBits);
+	    record.edgeY   = reader_.getFloat(precision_.positionBits);
+	    record.x       = reader_.getFloat(precision_.positionBits);
+	    record.y       = reader_.getFloat(precision_.positionBits);
+	    record.xErr    = reader_.getFloat(precision_.errorBits);
+	    record.yErr    = reader_.getFloat(precision_.errorBits);
+	    record.dXdZ    = reader_.getFloat(precision_.slopeBits);
+	    record.dYdZ    = reader_.getFloat(precision_.slopeBits);
+	    record.dXdZErr = reader_.getFloat(precision_.errorBits);
+	    record.dYdZErr = reader_.getFloat(precision_.errorBits);
+	 }
+
+	 void getSegment( MuonSegmentMatch& segment ) {
+	    segment.x       = reader_.getFloat(precision_.positionBits);
+	    segment.y       = reader_.getFloat(precision_.positionBits);
+	    segment.xErr    = reader_.getFloat(precision_.errorBits);
+	    segment.yErr    = reader_.getFloat(precision_.errorBits);
+	    segment.dXdZ    = reader_.getFloat(precision_.slopeBits);
+	    segment.dYdZ    = reader_.getFloat(precision_.slopeBits);
+	    segment.dXdZErr = reader_.getFloat(precision_.errorBits);
+	    segment.dYdZErr = reader_.getFloat(precision_.errorBits);
+	    segment.t0      = reader_.getFloat(precision_.positionBits);
+	    segment.mask    = reader_.get(32);
+	    segment.hasZed_ = reader_.get(1);
+	    segment.hasPhi_ = reader_.get(1);
+	    const unsigned int type = reader_.get(2);
+	    if ( type == MuonSegmentMatch::DTSegment )
+	       segment.setDTSegmentRef(DTRecSegment4DRef(edm::RefProd<DTRecSegment4DCollection>(dtSegments_), reader_.get(keyBits)));
+	    else if ( type == MuonSegmentMatch::CSCSegment )
+	       segment.setCSCSegmentRef(CSCSegmentRef(edm::RefProd<CSCSegmentCollection>(cscSegments_), reader_.get(keyBits)));
+	    else
+	       segment.setDTSegmentRef(DTRecSegment4DRef());
+	 }
+
+	 void getRPCHit( MuonRPCHitMatch& hit ) {
+	    hit.x    = reader_.getFloat(precision_.positionBits);
+	    hit.mask = reader_.get(32);
+	    hit.bx   = int(reader_.get(32));
+	 }
+
+      private:
+	 BitReader reader_;
+	 muon::MuonMatchPrecision precision_;
+	 const edm::RefCore& dtSegments_;
+	 const edm::RefCore& cscSegments_;
+   };
+}
+
+void MuonMatchBlock::pack( const std::vector<MuonChamberMatch>& matches, const muon::MuonMatchPrecision& precision )
+{
+   checkPrecision(precision);
+   clear();
+   if ( matches.empty() ) return;
+
+   unsigned int nSegments = 0;
+   unsigned int nRPCHits = 0;
+   for( std::vector<MuonChamberMatch>::const_iterator chamber = matches.begin();
+	chamber != matches.end(); ++chamber )
+   {
+      nSegments += chamber->segmentMatches.size();
+      nRPCHits += chamber->rpcMatches.size();
+   }
+   words_.resize(HeaderSize);
+   words_[Format]                 = formatWord(precision);
+   words_[NumberOfChambers]       = matches.size();
+   words_[NumberOfSegmentMatches] = nSegments;
+   words_[NumberOfRPCMatches]     = nRPCHits;
+
+   Encoder encoder(words_, precision, dtSegmentProduct_, cscSegmentProduct_);
+   for( std::vector<MuonChamberMatch>::const_iterator chamber = matches.begin();
+	chamber != matches.end(); ++chamber )
+      encoder.putChamber(*chamber, chamber->id.rawId(), chamber->segmentMatches.size(), chamber->rpcMatches.size());
+   for( std::vector<MuonChamberMatch>::const_iterator chamber = matches.begin();
+	chamber != matches.end(); ++chamber )
+      for( std::vector<MuonSegmentMatch>::const_iterator segment = chamber->segmentMatches.begin();
+	   segment != chamber->segmentMatches.end(); ++segment )
+	 encoder.putSegment(*segment);
+   for( std::vector<MuonChamberMatch>::const_iterator chamber = matches.begin();
+	chamber != matches.end(); ++chamber )
+      for( std::vector<MuonRPCHitMatch>::const_iterator hit = chamber->rpcMatches.begin();
+	   hit != chamber->rpcMatches.end(); ++hit )
+	 encoder.putRPCHit(*hit);
+   encoder.flush();
+}
+
+void MuonMatchBlock::pack( const std::vector<ChamberRecord>& chambers, const std::vector<MuonSegmentMatch>& segmentMatches,
+			   const std::vector<MuonRPCHitMatch>& rpcMatches, const muon::MuonMatchPrecision& precision )
+{
+   checkPrecision(precision);
+   clear();
+   if ( chambers.empty() ) return;
+
+   unsigned int nSegments = 0;
+   unsigned int nRPCHits = 0;
+   for( std::vector<ChamberRecord>::const_iterator chamber = chambers.begin(); chamber != chambers.end(); ++chamber )
+   {
+      nSegments += chamber->nSegmentMatches;
+      nRPCHits += chamber->nRPCMatches;
+   }
+   if ( nSegments != segmentMatches.size() || nRPCHits != rpcMatches.size() )
+      throw cms::Exception("MuonMatchBlock") << "the chambers hold " << nSegments << " segment and " << nRPCHits
+					     << " RPC hit matches, got " << segmentMatches.size() << " and " << rpcMatches.size();
+   words_.resize(HeaderSize);
+   words_[Format]                 = formatWord(precision);
+   words_[NumberOfChambers]       = chambers.size();
+   words_[NumberOfSegmentMatches] = nSegments;
+   words_[NumberOfRPCMatches]     = nRPCHits;
+
+   Encoder encoder(words_, precision, dtSegmentProduct_, cscSegmentProduct_);
+   for( std::vector<ChamberRecord>::const_iterator chamber = chambers.begin(); chamber != chambers.end(); ++chamber )
+      encoder.putChamber(*chamber, chamber->rawId, chamber->nSegmentMatches, chamber->nRPCMatches);
+   for( std::vector<MuonSegmentMatch>::const_iterator segment = segmentMatches.begin(); segment != segmentMatches.end(); ++segment )
+      encoder.putSegment(*segment);
+   for( std::vector<MuonRPCHitMatch>::const_iterator hit = rpcMatches.begin(); hit != rpcMatches.end(); ++hit )
+      encoder.putRPCHit(*hit);
+   encoder.flush();
+}
+
+void MuonMatchBlock::unpack( std::vector<MuonChamberMatch>& matches ) const
+{
+   matches.clear();
+   if ( words_.empty() ) return;
+   const muon::MuonMatchPrecision precision = checkedPrecision(words_[Format]);
+   matches.resize(words_[NumberOfChambers]);
+
+   // the chambers come first: size their lists, then fill them. Resizing
+   // allocates once per list, and not at all for empty lists
+   Decoder decoder(words_, HeaderSize, precision, dtSegmentProduct_, cscSegmentProduct_);
+   ChamberRecord record;
+   for( std::vector<MuonChamberMatch>::iterator chamber = matches.begin(); chamber != matches.end(); ++chamber )
+   {
+      decoder.getChamber(record);
+      chamber->edgeX   = record.edgeX;
+      chamber->edgeY   = record.edgeY;
+      chamber->x       = record.x;
+      chamber->y       = record.y;
+      chamber->xErr    = record.xErr;
+      chamber->yErr    = record.yErr;
+      chamber->dXdZ    = record.dXdZ;
+      chamber->dYdZ    = record.dYdZ;
+      chamber->dXdZErr = record.dXdZErr;
+      chamber->dYdZErr = record.dYdZErr;
+      chamber->id      = DetId(record.rawId);
+      chamber->segmentMatches.resize(record.nSegmentMatches);
+      chamber->rpcMatches.resize(record.nRPCMatches);
+   }
+   for( std::vector<MuonChamberMatch>::iterator chamber = matches.begin(); chamber != matches.end(); ++chamber )
+      for( std::vector<MuonSegmentMatch>::iterator segment = chamber->segmentMatches.begin();
+	   segment != chamber->segmentMatches.end(); ++segment )
+	 decoder.getSegment(*segment);
+   for( std::vector<MuonChamberMatch>::iterator chamber = matches.begin(); chamber != matches.end(); ++chamber )
+      for( std::vector<MuonRPCHitMatch>::iterator hit = chamber->rpcMatches.begin();
+	   hit != chamber->rpcMatches.end(); ++hit )
+	 decoder.getRPCHit(*hit);
+}
+
+const MuonMatchBlock::Content& MuonMatchBlock::content() const
+{
+   if ( !content_.isSet() ) {
+      // concurrent callers may all decode, only the first result is kept
+      std::unique_ptr<Content> content(new Content);
+      if ( !words_.empty() ) {
+	 const muon::MuonMatchPrecision precision = checkedPrecision(words_[Format]);
+	 content->chambers.resize(words_[NumberOfChambers]);
+	 content->segmentMatches.resize(words_[NumberOfSegmentMatches]);
+	 content->rpcMatches.resize(words_[NumberOfRPCMatches]);
+
+	 Decoder decoder(words_, HeaderSize, precision, dtSegmentProduct_, cscSegmentProduct_);
+	 for( std::vector<ChamberRecord>::iterator chamber = content->chambers.begin();
+	      chamber != content->chambers.end(); ++chamber )
+	    decoder.getChamber(*chamber);
+	 for( std::vector<MuonSegmentMatch>::iterator segment = content->segmentMatches.begin();
+	      segment != content->segmentMatches.end(); ++segment )
+	    decoder.getSegment(*segment);
+	 for( std::vector<MuonRPCHitMatch>::iterator hit = content->rpcMatches.begin();
+	      hit != content->rpcMatches.end(); ++hit )
+	    decoder.getRPCHit(*hit);
+      }
+      content_.set(std::move(content));
+   }
+   return *content_;
+}
+
+MuonMatchBlock::ChamberView MuonMatchBlock::firstChamber() const
+{
+   const Content& decoded = content();
+   return ChamberView(decoded.chambers.empty() ? 0 : &decoded.chambers[0],
+		      decoded.segmentMatches.empty() ? 0 : &decoded.segmentMatches[0],
+		      decoded.rpcMatches.empty() ? 0 : &decoded.rpcMatches[0]);
+}
+
+void MuonMatchBlock::clear()
+{
+   words_.clear();
+   dtSegmentProduct_ = edm::RefCore();
+   cscSegmentProduct_ = edm::RefCore();
+   content_.reset();
+}
+
+void MuonMatchBlock::swap( MuonMatchBlock& other )
+{
+   words_.swap(other.words_);
+   std::swap(dtSegmentProduct_, other.dtSegmentProduct_);
+   std::swap(cscSegmentProduct_, other.cscSegmentProduct_);
+   // the caches are rebuilt on demand
+   content_.reset();
+   other.content_.reset();
+}
@@ -0,0 +1,88 @@
+#include "DataFormats/MuonReco/interface/MuonRPCTiming.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonDetId/interface/RPCDetId.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+   int countBits( unsigned int mask )
+   {
+      int n = 0;
+      for ( ; mask; mask &= mask-1 ) ++n;
+      return n;
+   }
+}
+
+muon::MuonRPCTiming::MuonRPCTiming():
+  nHits(0), majorityBX(0), meanBX(0), spreadBX(0), layerMask(0), inTimeLayerMask(0)
+{
+   for ( int i = 0; i < nBX; ++i ) bxHits[i] = 0;
+}
+
+int muon::MuonRPCTiming::numberOfLayers() const { return countBits(layerMask); }
+
+int muon::MuonRPCTiming::numberOfInTimeLayers() const { return countBits(inTimeLayerMask); }
+
+int muon::rpcLayer( const reco::MuonChamberMatch& match )
+{
+   RPCDetId rollId = match.id.rawId();
+   const int region = rollId.region();
+   const int station = match.station();
+   if ( region != 0 ) return station + 6;
+
+   // maximum ten layers because of 6 layers in barrel and 3 (4) layers in each endcap before (after) upscope
+   const int layer = rollId.layer();
+   int rpcLayer = station-1 + station*layer;
+   if ((station==2 && layer==2) || (station==4 && layer==1)) rpcLayer -= 1;
+   return rpcLayer;
+}
+
+muon::MuonRPCTiming muon::rpcTiming( const reco::Muon& muon )
+{
+   MuonRPCTiming timing;
+   int sumBX = 0, sumBX2 = 0;
+   const std::vector<reco::MuonChamberMatch>& matches = muon.matches();
+   for ( std::vector<reco::MuonChamberMatch>::const_iterator chamber = matches.begin(); chamber != matches.end(); ++chamber ) {
+      if ( chamber->rpcMatches.empty() ) continue;
+      const unsigned int layerBit = 1<<(rpcLayer(*chamber)-1);
+      timing.layerMask |= layerBit;
+      for ( std::vector<reco::MuonRPCHitMatch>::const_iterator hit = chamber->rpcMatches.begin();
+	    hit != chamber->rpcMatches.end(); ++hit ) {
+	 const int bx = hit->bx;
+	 const int bin = bx < MuonRPCTiming::minBX ? 0 : bx > MuonRPCTiming::maxBX ? MuonRPCTiming::nBX-1 : bx - MuonRPCTiming::minBX;
+	 ++timing.bxHits[bin];
+	 ++timing.nHits;
+	 sumBX += bx;
+	 sumBX2 += bx*bx;
+	 if ( bx == 0 ) timing.inTimeLayerMask |= layerBit;
+      }
+   }
+   if ( timing.nHits == 0 ) return timing;
+
+   // the most populated bin, the one closest to BX 0 for ties
+   int best = -MuonRPCTiming::minBX;
+   for ( int i = 0; i < MuonRPCTiming::nBX; ++i ) {
+      const int bx = i + MuonRPCTiming::minBX;
+      if ( timing.bxHits[i] > timing.bxHits[best] ||
+	   ( timing.bxHits[i] == timing.bxHits[best] && std::abs(bx) < std::abs(best + MuonRPCTiming::minBX) ) )
+	 best = i;
+   }
+   timing.majorityBX = best + MuonRPCTiming::minBX;
+
+   timing.meanBX = float(sumBX)/timing.nHits;
+   const float variance = float(sumBX2)/timing.nHits - timing.meanBX*timing.meanBX;
+   timing.spreadBX = variance > 0 ? std::sqrt(variance) : 0;
+   return timing;
+}
+
+unsigned int muon::fillRPCTimings( const reco::MuonCollection& muons, std::vector<MuonRPCTiming>& timings,
+				   unsigned int minHits )
+{
+   timings.resize( muons.size() );
+   unsigned int nOutOfTime = 0;
+   for ( unsigned int i = 0; i < muons.size(); ++i ) {
+      timings[i] = rpcTiming( muons[i] );
+      if ( timings[i].isOutOfTime(minHits) ) ++nOutOfTime;
+   }
+   return nOutOfTime;
+}
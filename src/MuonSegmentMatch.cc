@@ -0,0 +1,48 @@
+#include "DataFormats/MuonReco/interface/MuonSegmentMatch.h"
+#include "FWCore/Utilities/interface/Exception.h"
+using namespace reco;
+
+namespace {
+   const unsigned int keyMask = (1u<<30)-1;
+
+   unsigned int packedKey( MuonSegmentMatch::SegmentType type, unsigned int key )
+   {
+      if ( key > keyMask )
+	 throw cms::Exception("MuonSegmentMatch") << "segment key " << key << " does not fit in the 30 bits of the packed key";
+      return (type<<30) | key;
+   }
+}
+
+DTRecSegment4DRef MuonSegmentMatch::dtSegmentRef() const
+{
+   if ( segmentType() != DTSegment ) return DTRecSegment4DRef();
+   return DTRecSegment4DRef( edm::RefProd<DTRecSegment4DCollection>(segmentProduct_), segmentKey_ & keyMask );
+}
+
+CSCSegmentRef MuonSegmentMatch::cscSegmentRef() const
+{
+   if ( segmentType() != CSCSegment ) return CSCSegmentRef();
+   return CSCSegmentRef( edm::RefProd<CSCSegmentCollection>(segmentProduct_), segmentKey_ & keyMask );
+}
+
+void MuonSegmentMatch::setDTSegmentRef( const DTRecSegment4DRef& ref )
+{
+   if ( ref.isNull() ) {
+      segmentProduct_ = edm::RefCore();
+      segmentKey_ = 0;
+      return;
+   }
+   segmentProduct_ = ref.refCore();
+   segmentKey_ = packedKey(DTSegment, ref.key());
+}
+
+void MuonSegmentMatch::setCSCSegmentRef( const CSCSegmentRef& ref )
+{
+   if ( ref.isNull() ) {
+      segmentProduct_ = edm::RefCore();
+      segmentKey_ = 0;
+      return;
+   }
+   segmentProduct_ = ref.refCore();
+   segmentKey_ = packedKey(CSCSegment, ref.key());
+}
@@ -1,4 +1,5 @@
 #include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/MuonReco/interface/MuonSnapshot.h"
 #include "DataFormats/TrackReco/interface/Track.h"
 #include "DataFormats/MuonDetId/interface/MuonSubdetId.h"
 #include "DataFormats/MuonDetId/interface/CSCDetId.h"
@@ -564,8 +565,26 @@ bool muon::isGoodMuon( const reco::Muon& muon,
    return goodMuon;
 }
 
-bool muon::isGoodMuon( const reco::Muon& muon, SelectionType type,
-		       reco::Muon::ArbitrationType arbitrationType)
+namespace muon {
+namespace {
+// Track access for the selectors through the TrackRefs of the muon.
+// The refs are dereferenced as before, so that a null ref still throws.
+class RefTracks {
+public:
+  explicit RefTracks( const reco::Muon& muon ) : muon_(muon) {}
+  const reco::Track* innerTrack()  const { return &*muon_.innerTrack(); }
+  const reco::Track* outerTrack()  const { return &*muon_.outerTrack(); }
+  const reco::Track* globalTrack() const { return &*muon_.globalTrack(); }
+  const reco::Track* bestTrack()   const { return &*muon_.muonBestTrack(); }
+private:
+  const reco::Muon& muon_;
+};
+
+// The selections below take their tracks from RefTracks, from a
+// muon::MuonTrackRow or from a muon::MuonSnapshotRow.
+template<typename Tracks>
+bool goodMuon( const reco::Muon& muon, const Tracks& tracks, SelectionType type,
+	       reco::Muon::ArbitrationType arbitrationType)
 {
   switch (type)
     {
@@ -588,7 +607,7 @@ bool muon::isGoodMuon( const reco::Muon& muon, SelectionType type,
       return ! muon.isTrackerMuon() || muon.numberOfMatches(arbitrationType)>0;
       break;
     case muon::GlobalMuonPromptTight:
-      return muon.isGlobalMuon() && muon.globalTrack()->normalizedChi2()<10. && muon.globalTrack()->hitPattern().numberOfValidMuonHits() >0;
+      return muon.isGlobalMuon() && tracks.globalTrack()->normalizedChi2()<10. && tracks.globalTrack()->hitPattern().numberOfValidMuonHits() >0;
       break;
       // For "Loose" algorithms we choose maximum y quantity cuts of 1E9 instead of
       // 9999 as before.  We do this because the muon methods return 999999 (note
@@ -633,10 +652,10 @@ bool muon::isGoodMuon( const reco::Muon& muon, SelectionType type,
       return muon.isTrackerMuon() && isGoodMuon(muon,TM2DCompatibility,1.0,arbitrationType);
       break;
     case muon::GMTkChiCompatibility:
-      return muon.isGlobalMuon() && muon.isQualityValid() && fabs(muon.combinedQuality().trkRelChi2 - muon.innerTrack()->normalizedChi2()) < 2.0;
+      return muon.isGlobalMuon() && muon.isQualityValid() && fabs(muon.combinedQuality().trkRelChi2 - tracks.innerTrack()->normalizedChi2()) < 2.0;
       break;
     case muon::GMStaChiCompatibility:
-      return muon.isGlobalMuon() && muon.isQualityValid() && fabs(muon.combinedQuality().staRelChi2 - muon.outerTrack()->normalizedChi2()) < 2.0;
+      return muon.isGlobalMuon() && muon.isQualityValid() && fabs(muon.combinedQuality().staRelChi2 - tracks.outerTrack()->normalizedChi2()) < 2.0;
       break;
     case muon::GMTkKinkTight:
       return muon.isGlobalMuon() && muon.isQualityValid() && muon.combinedQuality().trkKink < 100.0;
@@ -672,6 +691,26 @@ bool muon::isGoodMuon( const reco::Muon& muon, SelectionType type,
       return false;
     }
 }
+}
+}
+
+bool muon::isGoodMuon( const reco::Muon& muon, SelectionType type,
+		       reco::Muon::ArbitrationType arbitrationType)
+{
+  return goodMuon(muon, RefTracks(muon), type, arbitrationType);
+}
+
+bool muon::isGoodMuon( const reco::Muon& muon, const MuonTrackRow& tracks, SelectionType type,
+		       reco::Muon::ArbitrationType arbitrationType)
+{
+  return goodMuon(muon, tracks, type, arbitrationType);
+}
+
+bool muon::isGoodMuon( const reco::Muon& muon, const MuonSnapshotRow& tracks, SelectionType type,
+		       reco::Muon::ArbitrationType arbitrationType)
+{
+  return goodMuon(muon, tracks, type, arbitrationType);
+}
 
 bool muon::overlap( const reco::Muon& muon1, const reco::Muon& muon2, 
 		    double pullX, double pullY, bool checkAdjacentChambers)
@@ -742,60 +781,105 @@ bool muon::overlap( const reco::Muon& muon1, const reco::Muon& muon2,
 }
 
 
-bool muon::isTightMuon(const reco::Muon& muon, const reco::Vertex& vtx){
+namespace muon {
+namespace {
+template<typename Tracks>
+bool tightMuon(const reco::Muon& muon, const Tracks& tracks, const reco::Vertex& vtx){
 
   if(!muon.isPFMuon() || !muon.isGlobalMuon() ) return false;
 
-  bool muID = isGoodMuon(muon,GlobalMuonPromptTight) && (muon.numberOfMatchedStations() > 1);
+  bool muID = goodMuon(muon,tracks,GlobalMuonPromptTight,reco::Muon::SegmentAndTrackArbitration) && (muon.numberOfMatchedStations() > 1);
     
   
-  bool hits = muon.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
-    muon.innerTrack()->hitPattern().numberOfValidPixelHits() > 0; 
+  bool hits = tracks.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
+    tracks.innerTrack()->hitPattern().numberOfValidPixelHits() > 0; 
 
   
-  bool ip = fabs(muon.muonBestTrack()->dxy(vtx.position())) < 0.2 && fabs(muon.muonBestTrack()->dz(vtx.position())) < 0.5;
+  bool ip = fabs(tracks.bestTrack()->dxy(vtx.position())) < 0.2 && fabs(tracks.bestTrack()->dz(vtx.position())) < 0.5;
   
   return muID && hits && ip;
 }
 
 
-bool muon::isLooseMuon(const reco::Muon& muon){
-  return muon.isPFMuon() && ( muon.isGlobalMuon() || muon.isTrackerMuon());
-}
-
-
-bool muon::isSoftMuon(const reco::Muon& muon, const reco::Vertex& vtx){
+template<typename Tracks>
+bool softMuon(const reco::Muon& muon, const Tracks& tracks, const reco::Vertex& vtx){
 
-  bool muID = muon::isGoodMuon(muon, TMOneStationTight);
+  bool muID = goodMuon(muon, tracks, TMOneStationTight, reco::Muon::SegmentAndTrackArbitration);
 
   if(!muID) return false;
   
-  bool layers = muon.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
-    muon.innerTrack()->hitPattern().pixelLayersWithMeasurement() > 1;
+  bool layers = tracks.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
+    tracks.innerTrack()->hitPattern().pixelLayersWithMeasurement() > 1;
 
-  bool chi2 = muon.innerTrack()->normalizedChi2() < 1.8;  
+  bool chi2 = tracks.innerTrack()->normalizedChi2() < 1.8;  
   
-  bool ip = fabs(muon.innerTrack()->dxy(vtx.position())) < 3. && fabs(muon.innerTrack()->dz(vtx.position())) < 30.;
+  bool ip = fabs(tracks.innerTrack()->dxy(vtx.position())) < 3. && fabs(tracks.innerTrack()->dz(vtx.position())) < 30.;
   
   return muID && layers && ip && chi2 ;
 }
 
 
 
-bool muon::isHighPtMuon(const reco::Muon& muon, const reco::Vertex& vtx){
-  bool muID =   muon.isGlobalMuon() && muon.globalTrack()->hitPattern().numberOfValidMuonHits() >0 && (muon.numberOfMatchedStations() > 1);
+template<typename Tracks>
+bool highPtMuon(const reco::Muon& muon, const Tracks& tracks, const reco::Vertex& vtx){
+  bool muID =   muon.isGlobalMuon() && tracks.globalTrack()->hitPattern().numberOfValidMuonHits() >0 && (muon.numberOfMatchedStations() > 1);
   if(!muID) return false;
 
-  bool hits = muon.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
-    muon.innerTrack()->hitPattern().numberOfValidPixelHits() > 0; 
+  bool hits = tracks.innerTrack()->hitPattern().trackerLayersWithMeasurement() > 5 &&
+    tracks.innerTrack()->hitPattern().numberOfValidPixelHits() > 0; 
 
-  bool momQuality = muon.muonBestTrack()->ptError()/muon.muonBestTrack()->pt() < 0.3;
+  bool momQuality = tracks.bestTrack()->ptError()/tracks.bestTrack()->pt() < 0.3;
 
-  bool ip = fabs(muon.muonBestTrack()->dxy(vtx.position())) < 0.2 && fabs(muon.bestTrack()->dz(vtx.position())) < 0.5;
+  bool ip = fabs(tracks.bestTrack()->dxy(vtx.position())) < 0.2 && fabs(tracks.bestTrack()->dz(vtx.position())) < 0.5;
   
   return muID && hits && momQuality && ip;
 
 }
+}
+}
+
+bool muon::isTightMuon(const reco::Muon& muon, const reco::Vertex& vtx){
+  return tightMuon(muon, RefTracks(muon), vtx);
+}
+
+bool muon::isTightMuon(const reco::Muon& muon, const MuonTrackRow& tracks, const reco::Vertex& vtx){
+  return tightMuon(muon, tracks, vtx);
+}
+
+bool muon::isTightMuon(const reco::Muon& muon, const MuonSnapshotRow& tracks, const reco::Vertex& vtx){
+  return tightMuon(muon, tracks, vtx);
+}
+
+
+bool muon::isLooseMuon(const reco::Muon& muon){
+  return muon.isPFMuon() && ( muon.isGlobalMuon() || muon.isTrackerMuon());
+}
+
+
+bool muon::isSoftMuon(const reco::Muon& muon, const reco::Vertex& vtx){
+  return softMuon(muon, RefTracks(muon), vtx);
+}
+
+bool muon::isSoftMuon(const reco::Muon& muon, const MuonTrackRow& tracks, const reco::Vertex& vtx){
+  return softMuon(muon, tracks, vtx);
+}
+
+bool muon::isSoftMuon(const reco::Muon& muon, const MuonSnapshotRow& tracks, const reco::Vertex& vtx){
+  return softMuon(muon, tracks, vtx);
+}
+
+
+bool muon::isHighPtMuon(const reco::Muon& muon, const reco::Vertex& vtx){
+  return highPtMuon(muon, RefTracks(muon), vtx);
+}
+
+bool muon::isHighPtMuon(const reco::Muon& muon, const MuonTrackRow& tracks, const reco::Vertex& vtx){
+  return highPtMuon(muon, tracks, vtx);
+}
+
+bool muon::isHighPtMuon(const reco::Muon& muon, const MuonSnapshotRow& tracks, const reco::Vertex& vtx){
+  return highPtMuon(muon, tracks, vtx);
+}
 
 int muon::sharedSegments( const reco::Muon& mu, const reco::Muon& mu2, unsigned int segmentArbitrationMask ) {
     int ret = 0;
@@ -814,8 +898,7 @@ int muon::sharedSegments( const reco::Muon& mu, const reco::Muon& mu2, unsigned
                 for(std::vector<reco::MuonSegmentMatch>::const_iterator segmentMatch2 = chamberMatch2->segmentMatches.begin(); 
                     segmentMatch2 != chamberMatch2->segmentMatches.end(); ++segmentMatch2) {
                     if (!segmentMatch2->isMask(segmentArbitrationMask)) continue;
-                    if ((segmentMatch->cscSegmentRef.isNonnull() && segmentMatch->cscSegmentRef == segmentMatch2->cscSegmentRef) ||
-                        (segmentMatch-> dtSegmentRef.isNonnull() && segmentMatch-> dtSegmentRef == segmentMatch2-> dtSegmentRef) ) {
+                    if (segmentMatch->isSameSegment(*segmentMatch2)) {
                         ++ret;
                     } // is the same
                 } // segment of mu2 in chamber
@@ -0,0 +1,32 @@
+#include "DataFormats/MuonReco/interface/MuonShowerMatrix.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "FWCore/Utilities/interface/Exception.h"
+using namespace muon;
+
+void MuonShowerMatrix::fill( const reco::MuonShower* showers, unsigned int n )
+{
+   const unsigned int nStations = reco::MuonShower::nStations;
+   nMuons_ = n;
+   nStationHits_.resize(nStations*n);
+   nStationCorrelatedHits_.resize(nStations*n);
+   stationShowerSizeT_.resize(nStations*n);
+   stationShowerDeltaR_.resize(nStations*n);
+   for ( unsigned int s = 0; s < nStations; ++s ) {
+      const unsigned int row = s*n;
+      for ( unsigned int i = 0; i < n; ++i ) {
+	 nStationHits_[row+i]           = showers[i].nStationHits[s];
+	 nStationCorrelatedHits_[row+i] = showers[i].nStationCorrelatedHits[s];
+	 stationShowerSizeT_[row+i]     = showers[i].stationShowerSizeT[s];
+	 stationShowerDeltaR_[row+i]    = showers[i].stationShowerDeltaR[s];
+      }
+   }
+}
+
+void MuonShowerMatrix::fill( const edm::ValueMap<reco::MuonShower>& showers, const reco::MuonRefProd& muons )
+{
+   if ( !showers.contains(muons.id()) )
+      throw cms::Exception("MuonShowerMatrix") << "the MuonShower map has no entry for the muons " << muons.id();
+   // the values of the muons of one collection are contiguous in the map
+   const unsigned int n = muons->size();
+   fill( n ? &showers[reco::MuonRef(muons, 0)] : 0, n );
+}
@@ -0,0 +1,74 @@
+#include "DataFormats/MuonReco/interface/MuonShowerTagger.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace {
+   // Float bits as an integer with the ordering of the floats: the
+   // compiler only vectorizes the minimum and maximum of floats when
+   // allowed to ignore NaN and signed zeros, while the ones of integers
+   // always are. The transformation is its own inverse.
+   inline int32_t orderedBits( float value )
+   {
+      int32_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      return bits ^ ((bits >> 31) & 0x7fffffff);
+   }
+
+   inline float orderedValue( int32_t bits )
+   {
+      bits ^= (bits >> 31) & 0x7fffffff;
+      float value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+   }
+
+   // The hits of a station are reduced in one loop: the counts are
+   // summed and the extremes taken as selects, so that the compiler
+   // turns the loop into vector code. A station without hits keeps the
+   // zeros of the MuonShower constructor.
+   void fillStation( const muon::MuonShowerHits& hits, unsigned int begin, unsigned int end,
+		     unsigned int station, reco::MuonShower& shower )
+   {
+      if ( begin == end ) return;
+      const float* deltaEta = hits.deltaEta + begin;
+      const float* deltaPhi = hits.deltaPhi + begin;
+      const float* deltaT = hits.deltaT + begin;
+      const uint8_t* correlated = hits.correlated + begin;
+      const unsigned int n = end - begin;
+
+      int nCorrelated = 0;
+      int32_t minT = std::numeric_limits<int32_t>::max();
+      int32_t maxT = std::numeric_limits<int32_t>::min();
+      int32_t maxDeltaR2 = 0;
+      for ( unsigned int i = 0; i < n; ++i ) {
+	 const int32_t t = orderedBits(deltaT[i]);
+	 const int32_t deltaR2 = orderedBits(deltaEta[i]*deltaEta[i] + deltaPhi[i]*deltaPhi[i]);
+	 nCorrelated += correlated[i];
+	 minT = t < minT ? t : minT;
+	 maxT = t > maxT ? t : maxT;
+	 maxDeltaR2 = deltaR2 > maxDeltaR2 ? deltaR2 : maxDeltaR2;
+      }
+      shower.nStationHits[station] = n;
+      shower.nStationCorrelatedHits[station] = nCorrelated;
+      shower.stationShowerSizeT[station] = orderedValue(maxT) - orderedValue(minT);
+      shower.stationShowerDeltaR[station] = std::sqrt(orderedValue(maxDeltaR2));
+   }
+}
+
+reco::MuonShower muon::muonShower( const MuonShowerHits& hits, unsigned int i )
+{
+   const unsigned int nStations = reco::MuonShower::nStations;
+   const unsigned int* offsets = hits.offsets + i*nStations;
+   reco::MuonShower shower;
+   for ( unsigned int s = 0; s < nStations; ++s )
+      fillStation( hits, offsets[s], offsets[s+1], s, shower );
+   return shower;
+}
+
+void muon::fillMuonShowers( const MuonShowerHits& hits, unsigned int nMuons, std::vector<reco::MuonShower>& showers )
+{
+   showers.resize(nMuons);
+   for ( unsigned int i = 0; i < nMuons; ++i )
+      showers[i] = muonShower( hits, i );
+}
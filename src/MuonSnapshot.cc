@@ -0,0 +1,338 @@
+#include "DataFormats/MuonReco/interface/MuonSnapshot.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace muon;
+
+namespace {
+  const char snapshotMagic[8] = { 'M', 'U', 'S', 'N', 'A', 'P', 0, 0 };
+  const uint32_t snapshotVersion = 4;
+  // every section starts on a cache line
+  const uint64_t sectionAlignment = 64;
+
+  uint64_t aligned( uint64_t offset ) {
+    return (offset + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+  }
+
+  template<typename T>
+  void writeSection( FILE* file, uint64_t& offset, const std::vector<T>& data, const std::string& fileName ) {
+    static const char padding[sectionAlignment] = { 0 };
+    const uint64_t start = aligned(offset);
+    const size_t nBytes = data.size()*sizeof(T);
+    if ( std::fwrite(padding, 1, start-offset, file) != start-offset ||
+	 (nBytes > 0 && std::fwrite(&data[0], 1, nBytes, file) != nBytes) ) {
+      std::fclose(file);
+      throw cms::Exception("MuonSnapshot") << "cannot write " << fileName;
+    }
+    offset = start + nBytes;
+  }
+
+  void fillTrack( const reco::Track& track, MuonSnapshotTrack& snapshot ) {
+    snapshot.pt_      = track.pt();
+    snapshot.ptError_ = track.ptError();
+    snapshot.chi2_    = track.chi2();
+    snapshot.ndof_    = track.ndof();
+    snapshot.vx_ = track.vx();
+    snapshot.vy_ = track.vy();
+    snapshot.vz_ = track.vz();
+    snapshot.px_ = track.px();
+    snapshot.py_ = track.py();
+    snapshot.pz_ = track.pz();
+    snapshot.hitPattern_.validMuonHits  = track.hitPattern().numberOfValidMuonHits();
+    snapshot.hitPattern_.validPixelHits = track.hitPattern().numberOfValidPixelHits();
+    snapshot.hitPattern_.trackerLayers  = track.hitPattern().trackerLayersWithMeasurement();
+    snapshot.hitPattern_.pixelLayers    = track.hitPattern().pixelLayersWithMeasurement();
+  }
+}
+
+void MuonSnapshotWriter::addEvent( const reco::MuonCollection& muons )
+{
+  MuonTrackTable table;
+  fillMuonTrackTable(muons, table);
+  std::vector<MuonCocktailInputs> inputs;
+  fillCocktailInputs(table, inputs);
+  cocktailInputs_.insert(cocktailInputs_.end(), inputs.begin(), inputs.end());
+
+  if ( events_.empty() ) events_.push_back(0);
+  reco::MuonMatchBlock block;
+  for ( unsigned int i = 0; i < muons.size(); ++i ) {
+    const reco::Muon& muon = muons[i];
+    MuonSnapshotRecord record;
+    std::memset(static_cast<void*>(&record), 0, sizeof(record));
+    record.px = muon.px();
+    record.py = muon.py();
+    record.pz = muon.pz();
+    record.energy = muon.energy();
+    record.vx = muon.vx();
+    record.vy = muon.vy();
+    record.vz = muon.vz();
+    record.charge = muon.charge();
+    record.type = muon.type();
+    record.bestTrackType = muon.muonBestTrackType();
+    record.tunePBestTrackType = muon.tunePMuonBestTrackType();
+    record.caloCompatibility = muon.caloCompatibility();
+    if ( muon.isIsolationValid() ) record.flags |= MuonSnapshotRecord::IsolationValid;
+    record.isolationR03 = muon.isolationR03();
+    record.isolationR05 = muon.isolationR05();
+    if ( muon.isPFIsolationValid() ) record.flags |= MuonSnapshotRecord::PFIsolationValid;
+    record.nPFIsolations = muon.numberOfPFIsolations();
+    for ( unsigned int type = 0; type < record.nPFIsolations; ++type )
+      record.pfIsolations[type] = muon.pfIsolation(reco::Muon::PFIsolationType(type));
+    if ( muon.isQualityValid() ) record.flags |= MuonSnapshotRecord::QualityValid;
+    record.combinedQuality = muon.combinedQuality();
+    record.time = muon.time();
+
+    if ( muon.isMatchesValid() ) record.flags |= MuonSnapshotRecord::MatchesValid;
+    block.pack(muon.matches());
+    record.firstChamber = chambers_.size();
+    record.nChambers = block.size();
+    record.firstSegment = segments_.size();
+    record.firstRPCHit = rpcHits_.size();
+    chambers_.insert(chambers_.end(), block.chambers().begin(), block.chambers().end());
+    for ( std::vector<reco::MuonSegmentMatch>::const_iterator segment = block.segmentMatches().begin();
+	  segment != block.segmentMatches().end(); ++segment ) {
+      MuonSnapshotSegment snapshot;
+      std::memset(&snapshot, 0, sizeof(snapshot));
+      snapshot.x = segment->x;
+      snapshot.y = segment->y;
+      snapshot.xErr = segment->xErr;
+      snapshot.yErr = segment->yErr;
+      snapshot.dXdZ = segment->dXdZ;
+      snapshot.dYdZ = segment->dYdZ;
+      snapshot.dXdZErr = segment->dXdZErr;
+      snapshot.dYdZErr = segment->dYdZErr;
+      snapshot.t0 = segment->t0;
+      snapshot.mask = segment->mask;
+      snapshot.hasZed = segment->hasZed_;
+      snapshot.hasPhi = segment->hasPhi_;
+      segments_.push_back(snapshot);
+    }
+    rpcHits_.insert(rpcHits_.end(), block.rpcMatches().begin(), block.rpcMatches().end());
+    muons_.push_back(record);
+
+    for ( int type = 0; type < MuonTrackRow::nTrackTypes; ++type ) {
+      MuonSnapshotTrack track;
+      std::memset(&track, 0, sizeof(track));
+      const reco::Track* source = table[i].tracks[type];
+      if ( source ) fillTrack(*source, track);
+      trackValid_.push_back(source != 0);
+      tracks_.push_back(track);
+    }
+  }
+  events_.push_back(muons_.size());
+}
+
+void MuonSnapshotWriter::write( const std::string& fileName ) const
+{
+  MuonSnapshotHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+  header.version = snapshotVersion;
+  header.nEvents = numberOfEvents();
+  header.nMuons = muons_.size();
+  header.nChambers = chambers_.size();
+  header.nSegments = segments_.size();
+  header.nRPCHits = rpcHits_.size();
+
+  std::vector<uint32_t> events(events_);
+  if ( events.empty() ) events.push_back(0);
+
+  // the offsets only depend on the sizes, compute them before writing
+  uint64_t offset = sizeof(header);
+  const uint64_t sizes[MuonSnapshotHeader::nSections] = {
+    events.size()*sizeof(uint32_t),
+    muons_.size()*sizeof(MuonSnapshotRecord),
+    trackValid_.size()*sizeof(uint8_t),
+    tracks_.size()*sizeof(MuonSnapshotTrack),
+    cocktailInputs_.size()*sizeof(MuonCocktailInputs),
+    chambers_.size()*sizeof(reco::MuonMatchBlock::ChamberRecord),
+    segments_.size()*sizeof(MuonSnapshotSegment),
+    rpcHits_.size()*sizeof(reco::MuonRPCHitMatch) };
+  for ( int section = 0; section < MuonSnapshotHeader::nSections; ++section ) {
+    header.offsets[section] = aligned(offset);
+    offset = header.offsets[section] + sizes[section];
+  }
+
+  FILE* file = std::fopen(fileName.c_str(), "wb");
+  if ( !file ) throw cms::Exception("MuonSnapshot") << "cannot open " << fileName << " for writing";
+  if ( std::fwrite(&header, sizeof(header), 1, file) != 1 ) {
+    std::fclose(file);
+    throw cms::Exception("MuonSnapshot") << "cannot write " << fileName;
+  }
+  offset = sizeof(header);
+  writeSection(file, offset, events, fileName);
+  writeSection(file, offset, muons_, fileName);
+  writeSection(file, offset, trackValid_, fileName);
+  writeSection(file, offset, tracks_, fileName);
+  writeSection(file, offset, cocktailInputs_, fileName);
+  writeSection(file, offset, chambers_, fileName);
+  writeSection(file, offset, segments_, fileName);
+  writeSection(file, offset, rpcHits_, fileName);
+  if ( std::fclose(file) != 0 ) throw cms::Exception("MuonSnapshot") << "cannot write " << fileName;
+}
+
+void MuonSnapshotWriter::clear()
+{
+  events_.clear();
+  muons_.clear();
+  trackValid_.clear();
+  tracks_.clear();
+  cocktailInputs_.clear();
+  chambers_.clear();
+  segments_.clear();
+  rpcHits_.clear();
+}
+
+MuonSnapshot::MuonSnapshot( const std::string& fileName ) : data_(0), size_(0)
+{
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if ( fd < 0 ) throw cms::Exception("MuonSnapshot") << "cannot open " << fileName;
+  struct stat status;
+  if ( ::fstat(fd, &status) != 0 || status.st_size < (off_t)sizeof(MuonSnapshotHeader) ) {
+    ::close(fd);
+    throw cms::Exception("MuonSnapshot") << fileName << " is not a muon snapshot";
+  }
+  size_ = status.st_size;
+  data_ = ::mmap(0, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if ( data_ == MAP_FAILED ) {
+    data_ = 0;
+    throw cms::Exception("MuonSnapshot") << "cannot map " << fileName;
+  }
+
+  const char* base = static_cast<const char*>(data_);
+  header_ = reinterpret_cast<const MuonSnapshotHeader*>(base);
+  const uint64_t counts[MuonSnapshotHeader::nSections] = {
+    uint64_t(header_->nEvents)+1,
+    header_->nMuons,
+    uint64_t(header_->nMuons)*MuonTrackRow::nTrackTypes,
+    uint64_t(header_->nMuons)*MuonTrackRow::nTrackTypes,
+    header_->nMuons,
+    header_->nChambers,
+    header_->nSegments,
+    header_->nRPCHits };
+  const uint64_t recordSizes[MuonSnapshotHeader::nSections] = {
+    sizeof(uint32_t), sizeof(MuonSnapshotRecord), sizeof(uint8_t), sizeof(MuonSnapshotTrack),
+    sizeof(MuonCocktailInputs), sizeof(reco::MuonMatchBlock::ChamberRecord),
+    sizeof(MuonSnapshotSegment), sizeof(reco::MuonRPCHitMatch) };
+  bool valid = std::memcmp(header_->magic, snapshotMagic, sizeof(snapshotMagic)) == 0 &&
+    header_->version == snapshotVersion;
+  for ( int section = 0; valid && section < MuonSnapshotHeader::nSections; ++section )
+    valid = header_->offsets[section] % sectionAlignment == 0 &&
+      header_->offsets[section] + counts[section]*recordSizes[section] <= size_;
+  if ( !valid ) {
+    ::munmap(data_, size_);
+    data_ = 0;
+    throw cms::Exception("MuonSnapshot") << fileName << " is not a muon snapshot of version " << snapshotVersion;
+  }
+
+  events_         = reinterpret_cast<const uint32_t*>(base + header_->offsets[MuonSnapshotHeader::Events]);
+  muons_          = reinterpret_cast<const MuonSnapshotRecord*>(base + header_->offsets[MuonSnapshotHeader::Muons]);
+  trackValid_     = reinterpret_cast<const uint8_t*>(base + header_->offsets[MuonSnapshotHeader::TrackValid]);
+  tracks_         = reinterpret_cast<const MuonSnapshotTrack*>(base + header_->offsets[MuonSnapshotHeader::Tracks]);
+  cocktailInputs_ = reinterpret_cast<const MuonCocktailInputs*>(base + header_->offsets[MuonSnapshotHeader::CocktailInputs]);
+  chambers_       = reinterpret_cast<const reco::MuonMatchBlock::ChamberRecord*>(base + header_->offsets[MuonSnapshotHeader::Chambers]);
+  segments_       = reinterpret_cast<const MuonSnapshotSegment*>(base + header_->offsets[MuonSnapshotHeader::Segments]);
+  rpcHits_        = reinterpret_cast<const reco::MuonRPCHitMatch*>(base + header_->offsets[MuonSnapshotHeader::RPCHits]);
+}
+
+MuonSnapshot::~MuonSnapshot()
+{
+  if ( data_ ) ::munmap(data_, size_);
+}
+
+MuonSnapshotRow MuonSnapshot::trackRow( unsigned int iMuon ) const
+{
+  MuonSnapshotRow row;
+  row.tracks = tracks_ + iMuon*MuonTrackRow::nTrackTypes;
+  row.valid = trackValid_ + iMuon*MuonTrackRow::nTrackTypes;
+  row.bestTrackType = reco::Muon::MuonTrackType(muons_[iMuon].bestTrackType);
+  row.tunePBestTrackType = reco::Muon::MuonTrackType(muons_[iMuon].tunePBestTrackType);
+  return row;
+}
+
+void MuonSnapshot::fillMatches( unsigned int iMuon, std::vector<reco::MuonChamberMatch>& matches ) const
+{
+  const MuonSnapshotRecord& record = muons_[iMuon];
+  // the constructor only checked the sections, check the ranges of the
+  // muon against them before reading
+  bool valid = uint64_t(record.firstChamber) + record.nChambers <= header_->nChambers;
+  uint64_t nSegments = 0, nRPCHits = 0;
+  for ( unsigned int i = 0; valid && i < record.nChambers; ++i ) {
+    nSegments += chambers_[record.firstChamber+i].nSegmentMatches;
+    nRPCHits += chambers_[record.firstChamber+i].nRPCMatches;
+  }
+  valid = valid && record.firstSegment + nSegments <= header_->nSegments &&
+    record.firstRPCHit + nRPCHits <= header_->nRPCHits;
+  if ( !valid )
+    throw cms::Exception("MuonSnapshot") << "the matches of muon " << iMuon << " are beyond the end of the snapshot";
+
+  matches.clear();
+  matches.resize(record.nChambers);
+  const MuonSnapshotSegment* segment = segments_ + record.firstSegment;
+  const reco::MuonRPCHitMatch* rpcHit = rpcHits_ + record.firstRPCHit;
+  for ( unsigned int i = 0; i < record.nChambers; ++i ) {
+    const reco::MuonMatchBlock::ChamberRecord& chamberRecord = chambers_[record.firstChamber+i];
+    reco::MuonChamberMatch& chamber = matches[i];
+    chamber.edgeX   = chamberRecord.edgeX;
+    chamber.edgeY   = chamberRecord.edgeY;
+    chamber.x       = chamberRecord.x;
+    chamber.y       = chamberRecord.y;
+    chamber.xErr    = chamberRecord.xErr;
+    chamber.yErr    = chamberRecord.yErr;
+    chamber.dXdZ    = chamberRecord.dXdZ;
+    chamber.dYdZ    = chamberRecord.dYdZ;
+    chamber.dXdZErr = chamberRecord.dXdZErr;
+    chamber.dYdZErr = chamberRecord.dYdZErr;
+    chamber.id      = DetId(chamberRecord.rawId);
+
+    chamber.segmentMatches.resize(chamberRecord.nSegmentMatches);
+    for ( unsigned int j = 0; j < chamberRecord.nSegmentMatches; ++j, ++segment ) {
+      reco::MuonSegmentMatch& match = chamber.segmentMatches[j];
+      match.x = segment->x;
+      match.y = segment->y;
+      match.xErr = segment->xErr;
+      match.yErr = segment->yErr;
+      match.dXdZ = segment->dXdZ;
+      match.dYdZ = segment->dYdZ;
+      match.dXdZErr = segment->dXdZErr;
+      match.dYdZErr = segment->dYdZErr;
+      match.t0 = segment->t0;
+      match.mask = segment->mask;
+      match.hasZed_ = segment->hasZed;
+      match.hasPhi_ = segment->hasPhi;
+    }
+    chamber.rpcMatches.assign(rpcHit, rpcHit+chamberRecord.nRPCMatches);
+    rpcHit += chamberRecord.nRPCMatches;
+  }
+}
+
+void MuonSnapshot::fillMuon( unsigned int iMuon, reco::Muon& muon ) const
+{
+  const MuonSnapshotRecord& record = muons_[iMuon];
+  muon = reco::Muon(record.charge,
+		    reco::Muon::LorentzVector(record.px, record.py, record.pz, record.energy),
+		    reco::Muon::Point(record.vx, record.vy, record.vz));
+  muon.setType(record.type);
+  muon.setBestTrack(reco::Muon::MuonTrackType(record.bestTrackType));
+  muon.setTunePBestTrack(reco::Muon::MuonTrackType(record.tunePBestTrackType));
+  muon.setCaloCompatibility(record.caloCompatibility);
+  if ( record.flags & MuonSnapshotRecord::IsolationValid )
+    muon.setIsolation(record.isolationR03, record.isolationR05);
+  if ( record.flags & MuonSnapshotRecord::PFIsolationValid )
+    muon.setPFIsolations(record.pfIsolations, record.nPFIsolations);
+  if ( record.flags & MuonSnapshotRecord::QualityValid )
+    muon.setCombinedQuality(record.combinedQuality);
+  muon.setTime(record.time);
+  if ( record.flags & MuonSnapshotRecord::MatchesValid ) {
+    std::vector<reco::MuonChamberMatch> matches;
+    fillMatches(iMuon, matches);
+    muon.setMatches(matches);
+  }
+}
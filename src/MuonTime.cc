@@ -0,0 +1,14 @@
+#include "DataFormats/MuonReco/interface/MuonTime.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+using namespace reco;
+
+MuonTime::MuonTime( const MuonTimeExtra& extra ):
+  nDof(extra.nDof()),
+  timeAtIpInOut(extra.timeAtIpInOut()), timeAtIpInOutErr(extra.timeAtIpInOutErr()),
+  timeAtIpOutIn(extra.timeAtIpOutIn()), timeAtIpOutInErr(extra.timeAtIpOutInErr())
+{
+  setInverseBeta(extra.inverseBeta());
+  setInverseBetaErr(extra.inverseBetaErr());
+  setFreeInverseBeta(extra.freeInverseBeta());
+  setFreeInverseBetaErr(extra.freeInverseBetaErr());
+}
@@ -0,0 +1,163 @@
+#include "DataFormats/MuonReco/interface/MuonTimeClassifier.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+   // Muons are classified in blocks: the fields used are first copied
+   // from the timing objects into local arrays, then the
+   // decisions are taken over these arrays, as selects with no
+   // branches, which the compiler turns into vector code.
+   const unsigned int blockSize = 64;
+
+   struct TimeBlock {
+      int   nDof[blockSize];
+      float timeAtIpInOut[blockSize];
+      float timeAtIpInOutErr[blockSize];
+      float timeAtIpOutInErr[blockSize];
+      float inverseBeta[blockSize];
+      float inverseBetaErr[blockSize];
+
+      template<typename T>
+      void fill( const T* values, unsigned int n ) {
+	 for ( unsigned int i = 0; i < n; ++i ) set( i, timeOf(values[i]) );
+      }
+
+      void set( unsigned int i, const reco::MuonTime& time ) {
+	 nDof[i] = time.nDof;
+	 timeAtIpInOut[i] = time.timeAtIpInOut;
+	 timeAtIpInOutErr[i] = time.timeAtIpInOutErr;
+	 timeAtIpOutInErr[i] = time.timeAtIpOutInErr;
+	 inverseBeta[i] = time.inverseBeta();
+	 inverseBetaErr[i] = time.inverseBetaErr();
+      }
+
+      void set( unsigned int i, const reco::MuonTimeExtra& time ) {
+	 nDof[i] = time.nDof();
+	 timeAtIpInOut[i] = time.timeAtIpInOut();
+	 timeAtIpInOutErr[i] = time.timeAtIpInOutErr();
+	 timeAtIpOutInErr[i] = time.timeAtIpOutInErr();
+	 inverseBeta[i] = time.inverseBeta();
+	 inverseBetaErr[i] = time.inverseBetaErr();
+      }
+
+      static const reco::MuonTime& timeOf( const reco::MuonTime& time ) { return time; }
+      static const reco::MuonTime& timeOf( const reco::Muon& muon ) { return muon.time(); }
+      static const reco::MuonTimeExtra& timeOf( const reco::MuonTimeExtra& time ) { return time; }
+   };
+
+   // classify the n <= blockSize muons of a block, adding them to the
+   // summary; the per-muon results are only stored with Store, so that
+   // the summary alone does not pay for them
+   template<bool Store>
+   void classifyBlock( const TimeBlock& block, unsigned int n, const muon::MuonTimeClassifierParameters& parameters,
+		       muon::MuonTimeEventSummary& summary,
+		       int8_t* direction, float* inverseBetaPull, uint8_t* flags )
+   {
+      const int minNDof = parameters.minNDof;
+      const float maxTimeAtIp = parameters.maxTimeAtIp;
+      const float maxInverseBetaPull = parameters.maxInverseBetaPull;
+      unsigned int nMeasured = 0, nOutsideIn = 0, nOutOfTime = 0, nNotRelativistic = 0, nInTime = 0;
+      for ( unsigned int i = 0; i < n; ++i ) {
+	 const int measured = block.nDof[i] >= minNDof;
+	 const int outsideIn = measured & (block.timeAtIpInOutErr[i] > block.timeAtIpOutInErr[i]);
+	 const int outOfTime = measured & (std::fabs(block.timeAtIpInOut[i]) > maxTimeAtIp);
+	 const float error = block.inverseBetaErr[i];
+	 const int hasError = measured & (error > 0);
+	 // divided unconditionally, by 1 when there is no error; + 0 turns
+	 // the -0 of a negative deviation without error into 0
+	 const float pull = hasError*(block.inverseBeta[i] - 1.f)/(hasError*error + !hasError) + 0.f;
+	 const int notRelativistic = std::fabs(pull) > maxInverseBetaPull;
+
+	 nMeasured += measured;
+	 nOutsideIn += outsideIn;
+	 nOutOfTime += outOfTime;
+	 nNotRelativistic += notRelativistic;
+	 nInTime += measured & !outsideIn & !outOfTime;
+	 if ( Store ) {
+	    // InsideOut = 1, OutsideIn = -1, Undefined = 0
+	    direction[i] = measured - 2*outsideIn;
+	    inverseBetaPull[i] = pull;
+	    flags[i] = measured*muon::MuonTimeClasses::Measured | outsideIn*muon::MuonTimeClasses::OutsideIn |
+	               outOfTime*muon::MuonTimeClasses::OutOfTime | notRelativistic*muon::MuonTimeClasses::NotRelativistic;
+	 }
+      }
+      summary.nMeasured += nMeasured;
+      summary.nOutsideIn += nOutsideIn;
+      summary.nOutOfTime += nOutOfTime;
+      summary.nNotRelativistic += nNotRelativistic;
+      summary.nInTime += nInTime;
+   }
+
+   template<bool Store, typename T>
+   muon::MuonTimeEventSummary classify( const T* times, unsigned int n,
+					const muon::MuonTimeClassifierParameters& parameters,
+					int8_t* direction, float* inverseBetaPull, uint8_t* flags )
+   {
+      muon::MuonTimeEventSummary summary;
+      summary.nMuons = n;
+      TimeBlock block;
+      for ( unsigned int first = 0; first < n; first += blockSize ) {
+	 const unsigned int size = std::min(blockSize, n-first);
+	 block.fill( times+first, size );
+	 if ( Store ) classifyBlock<true>( block, size, parameters, summary, direction+first, inverseBetaPull+first, flags+first );
+	 else         classifyBlock<false>( block, size, parameters, summary, 0, 0, 0 );
+      }
+      return summary;
+   }
+
+   // the values of the muons of a collection, contiguous in the map
+   const reco::MuonTimeExtra* mapValues( const reco::MuonTimeExtraMap& times, const reco::MuonRefProd& muons )
+   {
+      if ( !times.contains(muons.id()) )
+	 throw cms::Exception("MuonTimeClassifier") << "the MuonTimeExtra map has no entry for the muons " << muons.id();
+      return muons->empty() ? 0 : &times[reco::MuonRef(muons, 0)];
+   }
+}
+
+muon::MuonTimeEventSummary muon::classifyMuonTimes( const reco::MuonCollection& muons, MuonTimeClasses& classes,
+						     const MuonTimeClassifierParameters& parameters )
+{
+   classes.resize(muons.size());
+   if ( muons.empty() ) return MuonTimeEventSummary();
+   return classify<true>( &muons[0], muons.size(), parameters, &classes.direction[0], &classes.inverseBetaPull[0], &classes.flags[0] );
+}
+
+muon::MuonTimeEventSummary muon::classifyMuonTimes( const reco::MuonTime* times, unsigned int n,
+						     MuonTimeClasses& classes,
+						     const MuonTimeClassifierParameters& parameters )
+{
+   classes.resize(n);
+   if ( n == 0 ) return MuonTimeEventSummary();
+   return classify<true>( times, n, parameters, &classes.direction[0], &classes.inverseBetaPull[0], &classes.flags[0] );
+}
+
+muon::MuonTimeEventSummary muon::classifyMuonTimes( const reco::MuonTimeExtraMap& times, const reco::MuonRefProd& muons,
+						     MuonTimeClasses& classes,
+						     const MuonTimeClassifierParameters& parameters )
+{
+   const reco::MuonTimeExtra* values = mapValues(times, muons);
+   const unsigned int n = muons->size();
+   classes.resize(n);
+   if ( n == 0 ) return MuonTimeEventSummary();
+   return classify<true>( values, n, parameters, &classes.direction[0], &classes.inverseBetaPull[0], &classes.flags[0] );
+}
+
+muon::MuonTimeEventSummary muon::summarizeMuonTimes( const reco::MuonCollection& muons,
+						      const MuonTimeClassifierParameters& parameters )
+{
+   return muons.empty() ? MuonTimeEventSummary() : classify<false>( &muons[0], muons.size(), parameters, 0, 0, 0 );
+}
+
+muon::MuonTimeEventSummary muon::summarizeMuonTimes( const reco::MuonTime* times, unsigned int n,
+						      const MuonTimeClassifierParameters& parameters )
+{
+   return classify<false>( times, n, parameters, 0, 0, 0 );
+}
+
+muon::MuonTimeEventSummary muon::summarizeMuonTimes( const reco::MuonTimeExtraMap& times, const reco::MuonRefProd& muons,
+						      const MuonTimeClassifierParameters& parameters )
+{
+   return classify<false>( mapValues(times, muons), muons->size(), parameters, 0, 0, 0 );
+}
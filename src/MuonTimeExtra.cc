@@ -1,4 +1,6 @@
 #include "DataFormats/MuonReco/interface/MuonTimeExtra.h"
+#include "DataFormats/MuonReco/interface/MuonTimeExtraMap.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
 using namespace reco;
 
 MuonTimeExtra::MuonTimeExtra() 
@@ -16,3 +18,9 @@ MuonTimeExtra::MuonTimeExtra()
   timeAtIpOutIn_=0.;
   timeAtIpOutInErr_=0.;
 }
+
+void muon::setTimes( reco::MuonCollection& muons, const reco::MuonRefProd& refProd, const reco::MuonTimeExtraMap& times )
+{
+  for ( unsigned int i = 0; i < muons.size(); ++i )
+    muons[i].setTime( MuonTime(times[reco::MuonRef(refProd, i)]) );
+}
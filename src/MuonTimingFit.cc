@@ -0,0 +1,76 @@
+#include "DataFormats/MuonReco/interface/MuonTimingFit.h"
+#include <cmath>
+
+namespace {
+   // cm/ns
+   const double speedOfLight = 29.9792458;
+
+   // weighted sums of x and x^2
+   struct WeightedSums {
+      unsigned int n;
+      double w, wx, wxx;
+      WeightedSums():n(0),w(0),wx(0),wxx(0) {}
+      void add( double x, double weight ) { ++n; w += weight; wx += weight*x; wxx += weight*x*x; }
+      double mean() const { return wx/w; }
+      // error of the mean from the weighted spread, never below the one
+      // from the weights alone, which is all a single measurement or
+      // identical measurements give
+      double error() const {
+	 const double weightError = 1./std::sqrt(w);
+	 if ( n < 2 ) return weightError;
+	 const double spread = wxx - wx*wx/w;
+	 const double spreadError = spread > 0 ? std::sqrt( spread/w/(n-1) ) : 0.;
+	 return spreadError > weightError ? spreadError : weightError;
+      }
+   };
+}
+
+reco::MuonTime muon::fitMuonTime( const double* t0, const double* distance, const double* error, unsigned int n )
+{
+   reco::MuonTime result;
+   if ( n == 0 ) return result;
+
+   // one pass over the arrays accumulates all the fits
+   WeightedSums inOut, outIn, inverseBeta;
+   double sx = 0, sxx = 0, sxy = 0;
+   for ( unsigned int i = 0; i < n; ++i ) {
+      const double weight = 1./(error[i]*error[i]);
+      const double x = distance[i]/speedOfLight;
+      inOut.add( t0[i], weight );
+      outIn.add( t0[i] + 2.*x, weight );
+      // 1/beta = 1 + t0/x, its error is the t0 error divided by x; a
+      // measurement at the interaction point does not constrain it
+      if ( x != 0 ) inverseBeta.add( 1. + t0[i]/x, weight*x*x );
+      // straight line fit of the arrival time t0 + x vs x
+      sx  += weight*x;
+      sxx += weight*x*x;
+      sxy += weight*x*(t0[i] + x);
+   }
+
+   result.timeAtIpInOut = inOut.mean();
+   result.timeAtIpInOutErr = inOut.error();
+   result.timeAtIpOutIn = outIn.mean();
+   result.timeAtIpOutInErr = outIn.error();
+   if ( inverseBeta.n > 0 ) {
+      result.setInverseBeta( inverseBeta.mean() );
+      result.setInverseBetaErr( inverseBeta.error() );
+   }
+
+   const double s = inOut.w;
+   const double sy = inOut.wx + sx;
+   const double delta = s*sxx - sx*sx;
+   if ( n > 1 && delta > 0 ) {
+      result.setFreeInverseBeta( (s*sxy - sx*sy)/delta );
+      result.setFreeInverseBetaErr( std::sqrt(s/delta) );
+   }
+
+   result.nDof = n;
+   return result;
+}
+
+void muon::fitMuonTimes( const MuonTimeMeasurements& measurements, std::vector<reco::MuonTime>& times )
+{
+   times.resize( measurements.size() );
+   for ( unsigned int i = 0; i < measurements.size(); ++i )
+      times[i] = fitMuonTime( measurements, i );
+}
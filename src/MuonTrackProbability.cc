@@ -0,0 +1,171 @@
+#include "DataFormats/MuonReco/interface/MuonTrackProbability.h"
+#include <cmath>
+#include <algorithm>
+
+namespace {
+  // the closed forms are used up to this number of degrees of freedom
+  const int kMaxTabulatedNdof = 100;
+  // above this x = chi2/2 the finite sums are rescaled by their largest term
+  const double kRescaleX = 100.;
+  // above this x exp(x)*erfc(sqrt(x)) is taken from its asymptotic expansion
+  const double kAsymptoticX = 600.;
+  // above this number of degrees of freedom ln Gamma(ndof/2) is taken from
+  // the Stirling series
+  const int kStirlingNdof = 50;
+
+  const double kEpsilon = 1e-16;
+  const double kTiny = 1e-300;
+  const int kMaxIterations = 10000;
+
+  // Precomputed coefficients of the closed forms, filled once.
+  struct Coefficients {
+    /// 1/i!, for the sums with even ndof
+    double even[kMaxTabulatedNdof/2];
+    /// 1/Gamma(i+3/2), for the sums with odd ndof
+    double odd[kMaxTabulatedNdof/2];
+    /// ln Gamma(ndof/2)
+    double lnGamma[kMaxTabulatedNdof+1];
+
+    Coefficients() {
+      double factorial = 1.;
+      double gammaHalf = 0.5*std::sqrt(M_PI); // Gamma(3/2)
+      for (int i = 0; i < kMaxTabulatedNdof/2; ++i) {
+	if (i > 0) factorial *= i;
+	even[i] = 1./factorial;
+	odd[i] = 1./gammaHalf;
+	gammaHalf *= i+1.5;
+      }
+      lnGamma[0] = 0.;  // unused
+      lnGamma[1] = 0.5*std::log(M_PI);
+      lnGamma[2] = 0.;
+      for (int ndof = 3; ndof <= kMaxTabulatedNdof; ++ndof)
+	lnGamma[ndof] = lnGamma[ndof-2] + std::log(0.5*(ndof-2));
+    }
+  };
+
+  const Coefficients& coefficients() {
+    static const Coefficients theCoefficients;
+    return theCoefficients;
+  }
+
+  // ln Gamma(a) - ((a-1/2) ln a - a + ln sqrt(2 pi)), from the Stirling
+  // series (error < 2e-16 for a > 25)
+  double stirlingCorrection(double a) {
+    const double inv = 1./a;
+    const double inv2 = inv*inv;
+    return inv*(1./12. - inv2*(1./360. - inv2*(1./1260. - inv2/1680.)));
+  }
+
+  // a ln x - x - ln Gamma(a), for a = ndof/2. For large a the terms are
+  // of order a ln a and cancel for x close to a: it is written as
+  // -a (t - ln(1+t)) + ln sqrt(a/(2 pi)) - stirlingCorrection(a), with
+  // t = (x-a)/a, whose rounding error is of order a |t| instead
+  double lnPowerExp(double x, int ndof) {
+    const double a = 0.5*ndof;
+    if (ndof <= kStirlingNdof) return a*std::log(x) - x - coefficients().lnGamma[ndof];
+    const double t = (x-a)/a;
+    return -a*(t - std::log1p(t)) + 0.5*std::log(a/(2.*M_PI)) - stirlingCorrection(a);
+  }
+
+  // ln sum_{i<m} c[i] x^i, with m >= 1
+  double lnPolynomialSum(const double* c, int m, double x) {
+    if (x <= kRescaleX) {
+      double sum = c[m-1];
+      for (int i = m-2; i >= 0; --i) sum = sum*x + c[i];
+      return std::log(sum);
+    }
+    // the last term is the largest one: factor x^(m-1) out and sum in 1/x
+    const double y = 1./x;
+    double sum = c[0];
+    for (int i = 1; i < m; ++i) sum = sum*y + c[i];
+    return (m-1)*std::log(x) + std::log(sum);
+  }
+
+  // ln(exp(x)*erfc(sqrt(x)))
+  double lnScaledErfc(double x) {
+    const double s = std::sqrt(x);
+    if (x < kAsymptoticX) return x + std::log(std::erfc(s));
+    // exp(x)*erfc(s) = 1/(s sqrt(pi)) * sum_n (-1)^n (2n-1)!!/(2x)^n,
+    // the terms beyond n = 6 are below 1e-16 for x >= 600
+    const double y = 0.5/x;
+    double term = 1.;
+    double sum = 1.;
+    for (int n = 1; n <= 6; ++n) {
+      term *= -(2*n-1)*y;
+      sum += term;
+    }
+    return std::log(sum/(s*std::sqrt(M_PI)));
+  }
+
+  double lnAdd(double lnA, double lnB) {
+    const double hi = std::max(lnA, lnB);
+    const double lo = std::min(lnA, lnB);
+    return hi + std::log1p(std::exp(lo-hi));
+  }
+
+  // -ln Q from the power series of the lower tail P = 1-Q, for x < a+1
+  double lowerTailSeries(double x, int ndof) {
+    const double a = 0.5*ndof;
+    double ap = a;
+    double term = 1./a;
+    double sum = term;
+    for (int n = 0; n < kMaxIterations; ++n) {
+      ap += 1.;
+      term *= x/ap;
+      sum += term;
+      if (term < sum*kEpsilon) break;
+    }
+    const double p = sum*std::exp(lnPowerExp(x, ndof));
+    return -std::log1p(-p);
+  }
+
+  // -ln Q from the continued fraction of the upper tail, for x >= a+1
+  double upperTailContinuedFraction(double x, int ndof) {
+    const double a = 0.5*ndof;
+    double b = x + 1. - a;
+    double c = 1./kTiny;
+    double d = 1./b;
+    double h = d;
+    for (int i = 1; i < kMaxIterations; ++i) {
+      const double an = -i*(i-a);
+      b += 2.;
+      d = an*d + b;
+      if (std::fabs(d) < kTiny) d = kTiny;
+      c = b + an/c;
+      if (std::fabs(c) < kTiny) c = kTiny;
+      d = 1./d;
+      const double delta = d*c;
+      h *= delta;
+      if (std::fabs(delta-1.) < kEpsilon) break;
+    }
+    return -lnPowerExp(x, ndof) - std::log(h);
+  }
+}
+
+double muon::chi2LogTailProbability(const double chi2, const int ndof) {
+
+  if (ndof <= 0 || !(chi2 > 0.)) return 0.;
+
+  const double x = 0.5*chi2;
+
+  // Q is close to one: take it from the lower tail to keep the
+  // precision on the small -ln Q
+  if (x < 0.5*ndof + 1.) return lowerTailSeries(x, ndof);
+
+  if (ndof > kMaxTabulatedNdof) return upperTailContinuedFraction(x, ndof);
+
+  const Coefficients& coef = coefficients();
+  const int m = ndof/2;
+  if (ndof%2 == 0)
+    return x - lnPolynomialSum(coef.even, m, x);
+
+  if (m == 0)
+    return x < kAsymptoticX ? -std::log(std::erfc(std::sqrt(x))) : x - lnScaledErfc(x);
+  const double lnSum = 0.5*std::log(x) + lnPolynomialSum(coef.odd, m, x);
+  return x - lnAdd(lnScaledErfc(x), lnSum);
+}
+
+void muon::chi2LogTailProbabilities(const double* chi2, const int* ndof, double* result, const unsigned int n) {
+  for (unsigned int i = 0; i < n; ++i)
+    result[i] = chi2LogTailProbability(chi2[i], ndof[i]);
+}
@@ -0,0 +1,20 @@
+#include "DataFormats/MuonReco/interface/MuonTrackTable.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+
+void muon::fillMuonTrackRow( const reco::Muon& muon, MuonTrackRow& row )
+{
+  row.tracks[reco::Muon::None] = 0;
+  for (int type = reco::Muon::InnerTrack; type < MuonTrackRow::nTrackTypes; ++type) {
+    const reco::TrackRef track = muon.muonTrack(reco::Muon::MuonTrackType(type));
+    row.tracks[type] = track.isNonnull() ? track.get() : 0;
+  }
+  row.bestTrackType = muon.muonBestTrackType();
+  row.tunePBestTrackType = muon.tunePMuonBestTrackType();
+}
+
+void muon::fillMuonTrackTable( const reco::MuonCollection& muons, MuonTrackTable& table )
+{
+  table.resize(muons.size());
+  for (unsigned int i = 0; i < muons.size(); ++i)
+    fillMuonTrackRow(muons[i], table[i]);
+}
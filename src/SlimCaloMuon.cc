@@ -0,0 +1,98 @@
+#include "DataFormats/MuonReco/interface/SlimCaloMuon.h"
+#include "DataFormats/MuonReco/interface/MuonReducedPrecision.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <algorithm>
+#include <cmath>
+using namespace reco;
+
+SlimCaloMuon::SlimCaloMuon():
+  trackKey_(noTrack), caloCompatibility_(invalidCompatibility), energyValid_(false)
+{
+   for ( int i = 0; i < nEnergies; ++i ) energies_[i] = 0;
+}
+
+SlimCaloMuon::SlimCaloMuon( const CaloMuon& muon ):
+  trackKey_(muon.innerTrack().isNonnull() ? muon.innerTrack().key() : noTrack),
+  caloCompatibility_(invalidCompatibility),
+  energyValid_(muon.isEnergyValid())
+{
+   const MuonEnergy& energy = muon.calEnergy();
+   energies_[EM]    = muon::floatToHalf(energy.em);
+   energies_[EMS9]  = muon::floatToHalf(energy.emS9);
+   energies_[Had]   = muon::floatToHalf(energy.had);
+   energies_[HadS9] = muon::floatToHalf(energy.hadS9);
+   energies_[HO]    = muon::floatToHalf(energy.ho);
+   energies_[HOS9]  = muon::floatToHalf(energy.hoS9);
+
+   // the compatibility is a probability, stored as a fraction of compatibilityScale
+   if ( muon.isCaloCompatibilityValid() ) {
+      const float compatibility = std::min( muon.caloCompatibility(), 1.f );
+      caloCompatibility_ = uint16_t( std::floor(compatibility*compatibilityScale + 0.5f) );
+   }
+}
+
+float SlimCaloMuon::energy( Energy energy ) const
+{
+   return muon::halfToFloat(energies_[energy]);
+}
+
+MuonEnergy SlimCaloMuon::calEnergy() const
+{
+   MuonEnergy energy;
+   energy.em    = em();
+   energy.emS9  = emS9();
+   energy.had   = had();
+   energy.hadS9 = hadS9();
+   energy.ho    = ho();
+   energy.hoS9  = hoS9();
+   return energy;
+}
+
+float SlimCaloMuon::caloCompatibility() const
+{
+   return isCaloCompatibilityValid() ? float(caloCompatibility_)/compatibilityScale : -9999.f;
+}
+
+CaloMuon SlimCaloMuon::caloMuon( const TrackRefProd& tracks ) const
+{
+   CaloMuon muon;
+   if ( hasTrack() ) muon.setInnerTrack( TrackRef(tracks, trackKey_) );
+   // CaloMuon::setCalEnergy marks the energy valid
+   if ( energyValid_ ) muon.setCalEnergy( calEnergy() );
+   muon.setCaloCompatibility( caloCompatibility() );
+   return muon;
+}
+
+SlimCaloMuons::SlimCaloMuons( const std::vector<CaloMuon>& muons )
+{
+   muons_.reserve( muons.size() );
+   for ( std::vector<CaloMuon>::const_iterator muon = muons.begin(); muon != muons.end(); ++muon )
+      push_back( *muon );
+}
+
+void SlimCaloMuons::push_back( const CaloMuon& muon )
+{
+   const TrackRef track = muon.innerTrack();
+   if ( track.isNonnull() ) {
+      if ( tracks_.isNull() )
+	 tracks_ = TrackRefProd( track );
+      else if ( track.id() != tracks_.id() )
+	 throw cms::Exception("SlimCaloMuons") << "the CaloMuon track is from the collection " << track.id()
+					       << ", not from the one of the others " << tracks_.id();
+   }
+   muons_.push_back( SlimCaloMuon(muon) );
+}
+
+void SlimCaloMuons::fill( std::vector<CaloMuon>& muons ) const
+{
+   muons.clear();
+   muons.reserve( muons_.size() );
+   for ( std::vector<SlimCaloMuon>::const_iterator muon = muons_.begin(); muon != muons_.end(); ++muon )
+      muons.push_back( muon->caloMuon(tracks_) );
+}
+
+void SlimCaloMuons::swap( SlimCaloMuons& other )
+{
+   std::swap( tracks_, other.tracks_ );
+   muons_.swap( other.muons_ );
+}
@@ -2,6 +2,7 @@
 #include "DataFormats/Common/interface/ValueMap.h"
 #include "DataFormats/MuonReco/interface/Muon.h"
 #include "DataFormats/MuonReco/interface/CaloMuon.h"
+#include "DataFormats/MuonReco/interface/SlimCaloMuon.h"
 #include "Rtypes.h" 
 #include "Math/Cartesian3D.h" 
 #include "Math/Polar3D.h" 
@@ -21,6 +22,8 @@
 #include "DataFormats/MuonReco/interface/MuonCosmicCompatibility.h"
 #include "DataFormats/MuonReco/interface/MuonShower.h"
 #include "DataFormats/MuonReco/interface/MuonToMuonMap.h"
+#include "DataFormats/MuonReco/interface/MuonTruthMatch.h"
+#include "DataFormats/MuonReco/interface/MuonAttachments.h"
 #include "DataFormats/TrackReco/interface/Track.h" 
 #include "DataFormats/Common/interface/AssociationMap.h"
 
@@ -40,7 +43,9 @@ namespace {
 
     reco::MuonIsolation rmi;
     reco::MuonPFIsolation rmi2;
+    std::vector<reco::MuonPFIsolation> vrmi2;
     reco::MuonTime rmt;
+    std::vector<reco::MuonTime> vrmt;
     reco::MuonTimeExtra rmt1;
     
     reco::Muon::MuonTrackType rmmttype;
@@ -57,6 +62,14 @@ namespace {
     std::vector<reco::MuonChamberMatch> vmm1;
     std::vector<reco::MuonSegmentMatch> vmm2;
     std::vector<reco::MuonRPCHitMatch>  vmm3;
+    reco::MuonMatchBlock mmb1;
+
+    reco::MuonChamberTruthMatch mctm1;
+    reco::MuonTruthMatches vmctm1;
+    std::vector<reco::MuonTruthMatches> vvmctm1;
+    reco::MuonTruthMatchMap mtmm1;
+    reco::MuonTruthMatchMap::const_iterator mtmmci1;
+    edm::Wrapper<reco::MuonTruthMatchMap> wmtmm1;
 
     std::vector<reco::MuonTrackLinks> tl1;
     edm::Wrapper<std::vector<reco::MuonTrackLinks> > tl2;
@@ -66,6 +79,10 @@ namespace {
 
     std::vector<reco::CaloMuon> smv1;
     edm::Wrapper<std::vector<reco::CaloMuon> > smc1;
+    reco::SlimCaloMuon scm1;
+    std::vector<reco::SlimCaloMuon> scm2;
+    reco::SlimCaloMuons scm3;
+    edm::Wrapper<reco::SlimCaloMuons> scm4;
 
     edm::reftobase::Holder<reco::Candidate, reco::MuonRef> hcc1;
     edm::reftobase::RefHolder<reco::MuonRef> hcc2;
@@ -118,6 +135,10 @@ namespace {
     edm::ValueMap<reco::MuonShower> rms_vm;
     edm::ValueMap<reco::MuonShower>::const_iterator rms_vmci;
     edm::Wrapper<edm::ValueMap<reco::MuonShower> > rms_wvm;
+
+    //attachments of all the blocks above
+    reco::MuonAttachments rmatt;
+    edm::Wrapper<reco::MuonAttachments> rmatt_w;
     
     //Ptrs
 #include "DataFormats/Common/interface/Ptr.h"
@@ -0,0 +1,158 @@
+// Benchmark of the energy, quality and time block accessors of
+// reco::Muon and reco::CaloMuon in a selector-like loop. The accessors
+// returning the blocks by value are modelled by copies of the classes
+// holding the same blocks, with the old inline accessors returning by
+// value; the same copies with the accessors returning a const reference
+// isolate the effect of the return type from the rest of the layout.
+//
+// usage: benchmarkMuonBlockAccess [nMuons] [nLoops]
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonFwd.h"
+#include "DataFormats/MuonReco/interface/CaloMuon.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+   float uniform( float min, float max ) { return min + (max-min)*rand()/float(RAND_MAX); }
+
+   reco::MuonCollection makeMuons( unsigned int nMuons )
+   {
+      reco::MuonCollection muons;
+      for(unsigned int i = 0; i < nMuons; ++i) {
+	 const double pt = uniform(2., 100.);
+	 reco::Muon muon(1, reco::Candidate::LorentzVector(pt, 0., 0., pt));
+	 reco::MuonEnergy energy;
+	 energy.em = uniform(0., 3.);
+	 energy.had = uniform(0., 8.);
+	 energy.ho = uniform(0., 2.);
+	 energy.emS9 = energy.em*1.2;
+	 energy.hadS9 = energy.had*1.2;
+	 muon.setCalEnergy(energy);
+	 reco::MuonQuality quality;
+	 quality.trkKink = uniform(0., 40.);
+	 quality.chi2LocalPosition = uniform(0., 20.);
+	 quality.staRelChi2 = uniform(0., 5.);
+	 muon.setCombinedQuality(quality);
+	 reco::MuonTime time;
+	 time.nDof = rand()%6;
+	 time.timeAtIpInOut = uniform(-30., 30.);
+	 time.timeAtIpInOutErr = uniform(0.5, 5.);
+	 muon.setTime(time);
+	 muons.push_back(muon);
+      }
+      return muons;
+   }
+
+   // the blocks of reco::Muon and reco::CaloMuon, with their accessors
+   // as they were (by value) and as they are (by const reference)
+   struct MuonBlocks {
+      explicit MuonBlocks( const reco::Muon& muon ):
+	 calEnergy_(muon.calEnergy()),combinedQuality_(muon.combinedQuality()),time_(muon.time()) {}
+      reco::MuonEnergy calEnergy_;
+      reco::MuonQuality combinedQuality_;
+      reco::MuonTime time_;
+   };
+
+   struct MuonByValue : public MuonBlocks {
+      explicit MuonByValue( const reco::Muon& muon ): MuonBlocks(muon) {}
+      reco::MuonEnergy calEnergy() const { return calEnergy_; }
+      reco::MuonQuality combinedQuality() const { return combinedQuality_; }
+      reco::MuonTime time() const { return time_; }
+   };
+
+   struct MuonByReference : public MuonBlocks {
+      explicit MuonByReference( const reco::Muon& muon ): MuonBlocks(muon) {}
+      const reco::MuonEnergy& calEnergy() const { return calEnergy_; }
+      const reco::MuonQuality& combinedQuality() const { return combinedQuality_; }
+      const reco::MuonTime& time() const { return time_; }
+   };
+
+   struct CaloMuonByValue {
+      explicit CaloMuonByValue( const reco::CaloMuon& muon ): calEnergy_(muon.calEnergy()) {}
+      reco::MuonEnergy calEnergy() const { return calEnergy_; }
+      reco::MuonEnergy calEnergy_;
+   };
+
+   struct CaloMuonByReference {
+      explicit CaloMuonByReference( const reco::CaloMuon& muon ): calEnergy_(muon.calEnergy()) {}
+      const reco::MuonEnergy& calEnergy() const { return calEnergy_; }
+      reco::MuonEnergy calEnergy_;
+   };
+
+   // the same cuts, written as the selectors write them: one accessor
+   // call per quantity; functors, so that the selection is inlined in
+   // the timing loop
+   template<typename Muon>
+   struct SelectMuon {
+      bool operator()( const Muon& muon ) const {
+	 return muon.calEnergy().em < 2. && muon.calEnergy().had < 6. && muon.calEnergy().ho < 1.5 &&
+		muon.combinedQuality().trkKink < 30. && muon.combinedQuality().chi2LocalPosition < 15. &&
+		( muon.time().nDof < 2 || std::fabs(muon.time().timeAtIpInOut) < 3.*muon.time().timeAtIpInOutErr + 10. );
+      }
+   };
+
+   template<typename CaloMuon>
+   struct SelectCaloMuon {
+      bool operator()( const CaloMuon& muon ) const {
+	 return muon.calEnergy().em < 2. && muon.calEnergy().had < 6. && muon.calEnergy().hoS9 < 1.5;
+      }
+   };
+
+   template<typename Copy, typename Original>
+   std::vector<Copy> copy( const std::vector<Original>& muons )
+   {
+      std::vector<Copy> copies;
+      copies.reserve(muons.size());
+      for(unsigned int i = 0; i < muons.size(); ++i) copies.push_back(Copy(muons[i]));
+      return copies;
+   }
+
+   template<typename Muons, typename Selector>
+   double time( const Muons& muons, unsigned int nLoops, Selector select, unsigned int& nSelected )
+   {
+      nSelected = 0;
+      const std::clock_t start = std::clock();
+      for(unsigned int loop = 0; loop < nLoops; ++loop)
+	 for(unsigned int i = 0; i < muons.size(); ++i)
+	    if (select(muons[i])) ++nSelected;
+      return double(std::clock()-start)/CLOCKS_PER_SEC;
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const unsigned int nMuons = argc > 1 ? atoi(argv[1]) : 10000;
+   const unsigned int nLoops = argc > 2 ? atoi(argv[2]) : 200;
+
+   srand(1);
+   const reco::MuonCollection muons = makeMuons(nMuons);
+   std::vector<reco::CaloMuon> caloMuons(nMuons);
+   for(unsigned int i = 0; i < nMuons; ++i) caloMuons[i].setCalEnergy(muons[i].calEnergy());
+
+   const std::vector<MuonByValue> muonsByValue = copy<MuonByValue>(muons);
+   const std::vector<MuonByReference> muonsByReference = copy<MuonByReference>(muons);
+   const std::vector<CaloMuonByValue> caloMuonsByValue = copy<CaloMuonByValue>(caloMuons);
+   const std::vector<CaloMuonByReference> caloMuonsByReference = copy<CaloMuonByReference>(caloMuons);
+
+   unsigned int nValue, nReference, nMuon, nCaloValue, nCaloReference, nCaloMuon;
+   const double tValue         = time(muonsByValue, nLoops, SelectMuon<MuonByValue>(), nValue);
+   const double tReference     = time(muonsByReference, nLoops, SelectMuon<MuonByReference>(), nReference);
+   const double tMuon          = time(muons, nLoops, SelectMuon<reco::Muon>(), nMuon);
+   const double tCaloValue     = time(caloMuonsByValue, nLoops, SelectCaloMuon<CaloMuonByValue>(), nCaloValue);
+   const double tCaloReference = time(caloMuonsByReference, nLoops, SelectCaloMuon<CaloMuonByReference>(), nCaloReference);
+   const double tCaloMuon      = time(caloMuons, nLoops, SelectCaloMuon<reco::CaloMuon>(), nCaloMuon);
+
+   const double nCalls = double(nMuons)*nLoops;
+   printf("%u muons x %u loops\n", nMuons, nLoops);
+   printf("Muon blocks by value          : %8.2f ns/muon, %u selected\n", 1e9*tValue/nCalls, nValue);
+   printf("Muon blocks by reference      : %8.2f ns/muon, %u selected\n", 1e9*tReference/nCalls, nReference);
+   printf("reco::Muon                    : %8.2f ns/muon, %u selected\n", 1e9*tMuon/nCalls, nMuon);
+   printf("CaloMuon energy by value      : %8.2f ns/muon, %u selected\n", 1e9*tCaloValue/nCalls, nCaloValue);
+   printf("CaloMuon energy by reference  : %8.2f ns/muon, %u selected\n", 1e9*tCaloReference/nCalls, nCaloReference);
+   printf("reco::CaloMuon                : %8.2f ns/muon, %u selected\n", 1e9*tCaloMuon/nCalls, nCaloMuon);
+   return 0;
+}
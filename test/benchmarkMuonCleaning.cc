@@ -0,0 +1,99 @@
+// Benchmark of muon::MuonGhostCleaner against the naive pairwise loop
+// at high muon multiplicity.
+//
+// usage: benchmarkMuonCleaning [nMuons] [nEvents]
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonCleaning.h"
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/MuonDetId/interface/DTChamberId.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+namespace {
+   // Muons spread over the barrel, one chamber per station. Every
+   // tenth muon is a ghost of the previous one, sharing its chambers
+   // and (in the overlap sense) its track positions.
+   reco::MuonCollection makeEvent( unsigned int nMuons, unsigned int seed )
+   {
+      srand(seed);
+      reco::MuonCollection muons;
+      for(unsigned int i = 0; i < nMuons; ++i) {
+	 const bool ghost = i%10 == 9;
+	 const reco::Muon* original = ghost ? &muons.back() : 0;
+	 const double pt = ghost ? original->pt()*0.9 : 5. + rand()%200;
+	 reco::Muon muon(1, reco::Candidate::LorentzVector(pt, 0., 0., pt));
+	 muon.setType(reco::Muon::TrackerMuon);
+
+	 std::vector<reco::MuonChamberMatch> matches;
+	 const int wheel  = rand()%5-2;
+	 const int sector = rand()%12+1;
+	 for(int station = 1; station <= 4; ++station) {
+	    reco::MuonChamberMatch chamber;
+	    chamber.id = ghost ? original->matches()[station-1].id : DTChamberId(wheel, station, sector);
+	    chamber.x = ghost ? original->matches()[station-1].x : rand()%200-100.;
+	    chamber.y = ghost ? original->matches()[station-1].y : rand()%200-100.;
+	    chamber.xErr = chamber.yErr = 0.5;
+	    chamber.edgeX = chamber.edgeY = -10.;
+	    reco::MuonSegmentMatch segment;
+	    segment.x = chamber.x;
+	    segment.y = chamber.y;
+	    segment.mask = reco::MuonSegmentMatch::BestInChamberByDR | reco::MuonSegmentMatch::BelongsToTrackByDR;
+	    chamber.segmentMatches.push_back(segment);
+	    matches.push_back(chamber);
+	 }
+	 muon.setMatches(matches);
+	 muons.push_back(muon);
+      }
+      return muons;
+   }
+
+   unsigned int naiveClean( const reco::MuonCollection& muons )
+   {
+      unsigned int nGhosts = 0;
+      for(unsigned int i = 0; i < muons.size(); ++i)
+	 for(unsigned int j = 0; j < muons.size(); ++j) {
+	    if (i == j) continue;
+	    if (!muon::overlap(muons[i], muons[j]) && muon::sharedSegments(muons[i], muons[j]) == 0) continue;
+	    if (muons[j].numberOfMatches() > muons[i].numberOfMatches() ||
+		(muons[j].numberOfMatches() == muons[i].numberOfMatches() && muons[j].pt() > muons[i].pt())) {
+	       ++nGhosts;
+	       break;
+	    }
+	 }
+      return nGhosts;
+   }
+}
+
+int main( int argc, char** argv )
+{
+   const unsigned int nMuons  = argc > 1 ? atoi(argv[1]) : 500;
+   const unsigned int nEvents = argc > 2 ? atoi(argv[2]) : 20;
+
+   std::vector<reco::MuonCollection> events;
+   for(unsigned int i = 0; i < nEvents; ++i) events.push_back(makeEvent(nMuons, i));
+
+   muon::MuonGhostCleaner cleaner;
+   std::vector<int> ghostOf;
+
+   unsigned int nNaive = 0;
+   std::clock_t start = std::clock();
+   for(unsigned int i = 0; i < nEvents; ++i) nNaive += naiveClean(events[i]);
+   const double tNaive = double(std::clock()-start)/CLOCKS_PER_SEC;
+
+   unsigned int nCleaner = 0;
+   start = std::clock();
+   for(unsigned int i = 0; i < nEvents; ++i) {
+      cleaner.clean(events[i], ghostOf);
+      for(unsigned int j = 0; j < ghostOf.size(); ++j)
+	 if (ghostOf[j] >= 0) ++nCleaner;
+   }
+   const double tCleaner = double(std::clock()-start)/CLOCKS_PER_SEC;
+
+   printf("%u events x %u muons\n", nEvents, nMuons);
+   printf("naive pairwise loop : %8.3f ms/event, %u ghosts\n", 1000.*tNaive/nEvents, nNaive);
+   printf("MuonGhostCleaner    : %8.3f ms/event, %u ghosts\n", 1000.*tCleaner/nEvents, nCleaner);
+   return 0;
+}
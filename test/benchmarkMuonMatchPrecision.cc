@@ -0,0 +1,138 @@
+// Read-throughput benchmark of muon collections written with the chamber
+// and segment matches as nested vectors, packed with full precision and
+// packed with reduced precision (see MuonMatchBlock.h and
+// MuonReducedPrecision.h): compressed size and read rate of a TTree of
+// std::vector<reco::Muon>.
+//
+// usage: benchmarkMuonMatchPrecision [nEvents] [positionBits] [slopeBits] [errorBits]
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonReco/interface/MuonReducedPrecision.h"
+#include "DataFormats/MuonDetId/interface/DTChamberId.h"
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace {
+   float uniform( float min, float max ) { return min + (max-min)*rand()/float(RAND_MAX); }
+
+   // a few muons per event, each matched in the four DT stations with
+   // two segments per chamber
+   reco::MuonCollection makeEvent()
+   {
+      reco::MuonCollection muons;
+      const unsigned int nMuons = 1 + rand()%4;
+      for(unsigned int i = 0; i < nMuons; ++i) {
+	 const double pt = uniform(5., 200.);
+	 reco::Muon muon(1, reco::Candidate::LorentzVector(pt, 0., 0., pt));
+	 std::vector<reco::MuonChamberMatch> matches;
+	 const int wheel  = rand()%5-2;
+	 const int sector = rand()%12+1;
+	 for(int station = 1; station <= 4; ++station) {
+	    reco::MuonChamberMatch chamber;
+	    chamber.id = DTChamberId(wheel, station, sector);
+	    chamber.x = uniform(-100., 100.);
+	    chamber.y = uniform(-100., 100.);
+	    chamber.edgeX = uniform(-50., 0.);
+	    chamber.edgeY = uniform(-50., 0.);
+	    chamber.xErr = uniform(0.01, 2.);
+	    chamber.yErr = uniform(0.01, 2.);
+	    chamber.dXdZ = uniform(-1., 1.);
+	    chamber.dYdZ = uniform(-1., 1.);
+	    chamber.dXdZErr = uniform(0.001, 0.1);
+	    chamber.dYdZErr = uniform(0.001, 0.1);
+	    for(int iSegment = 0; iSegment < 2; ++iSegment) {
+	       reco::MuonSegmentMatch segment;
+	       segment.x = chamber.x + uniform(-1., 1.);
+	       segment.y = chamber.y + uniform(-1., 1.);
+	       segment.xErr = uniform(0.01, 0.1);
+	       segment.yErr = uniform(0.01, 0.1);
+	       segment.dXdZ = chamber.dXdZ + uniform(-0.01, 0.01);
+	       segment.dYdZ = chamber.dYdZ + uniform(-0.01, 0.01);
+	       segment.dXdZErr = uniform(0.001, 0.01);
+	       segment.dYdZErr = uniform(0.001, 0.01);
+	       segment.t0 = uniform(-5., 5.);
+	       segment.mask = reco::MuonSegmentMatch::BestInChamberByDR;
+	       segment.hasZed_ = segment.hasPhi_ = true;
+	       chamber.segmentMatches.push_back(segment);
+	    }
+	    matches.push_back(chamber);
+	 }
+	 muon.setMatches(matches);
+	 muons.push_back(muon);
+      }
+      return muons;
+   }
+
+   /// the events are copied into the branch buffer, packed with the given
+   /// precision if pack is set
+   void write( const std::string& fileName, const std::vector<reco::MuonCollection>& events,
+	       bool pack, const muon::MuonMatchPrecision& precision = muon::MuonMatchPrecision() )
+   {
+      TFile file(fileName.c_str(), "RECREATE");
+      TTree tree("Events", "Events");
+      reco::MuonCollection muons;
+      reco::MuonCollection* branch = &muons;
+      tree.Branch("muons", &branch);
+      for(unsigned int i = 0; i < events.size(); ++i) {
+	 muons = events[i];
+	 if (pack)
+	    for(reco::MuonCollection::iterator muon = muons.begin(); muon != muons.end(); ++muon)
+	       muon->packMatches(precision);
+	 tree.Fill();
+      }
+      tree.Write();
+   }
+
+   void read( const std::string& fileName )
+   {
+      TFile file(fileName.c_str());
+      TTree* tree = (TTree*) file.Get("Events");
+      reco::MuonCollection* muons = 0;
+      tree->SetBranchAddress("muons", &muons);
+
+      unsigned int nChambers = 0;
+      std::clock_t start = std::clock();
+      const Long64_t nEntries = tree->GetEntries();
+      for(Long64_t i = 0; i < nEntries; ++i) {
+	 tree->GetEntry(i);
+	 for(unsigned int j = 0; j < muons->size(); ++j) nChambers += (*muons)[j].matches().size();
+      }
+      const double time = double(std::clock()-start)/CLOCKS_PER_SEC;
+
+      const Long64_t zipBytes = tree->GetZipBytes();
+      printf("%-22s: %9lld bytes on disk (%9lld unzipped), %8.1f kevents/s, %6.1f MB/s (%u chambers)\n",
+	     fileName.c_str(), zipBytes, tree->GetTotBytes(), 1e-3*nEntries/time, 1e-6*zipBytes/time, nChambers);
+      delete muons;
+   }
+}
+
+int main( int argc, char** argv )
+{
+   AutoLibraryLoader::enable();
+
+   const unsigned int nEvents = argc > 1 ? atoi(argv[1]) : 20000;
+   const muon::MuonMatchPrecision reduced = muon::MuonMatchPrecision::reduced();
+   const muon::MuonMatchPrecision precision(argc > 2 ? atoi(argv[2]) : reduced.positionBits,
+					    argc > 3 ? atoi(argv[3]) : reduced.slopeBits,
+					    argc > 4 ? atoi(argv[4]) : reduced.errorBits);
+
+   srand(1);
+   std::vector<reco::MuonCollection> events;
+   for(unsigned int i = 0; i < nEvents; ++i) events.push_back(makeEvent());
+   write("muonsUnpacked.root", events, false);
+   write("muonsFullPrecision.root", events, true);
+   write("muonsReducedPrecision.root", events, true, precision);
+
+   printf("%u events, reduced precision with %d/%d/%d mantissa bits for positions/slopes/errors\n",
+	  nEvents, precision.positionBits, precision.slopeBits, precision.errorBits);
+   read("muonsUnpacked.root");
+   read("muonsFullPrecision.root");
+   read("muonsReducedPrecision.root");
+   return 0;
+}
@@ -0,0 +1,120 @@
+// Read rate of muon collections from a file written with an older
+// reco::Muon ClassVersion, which goes through the schema evolution
+// and the ioread rules of classes_def.xml, compared with the same
+// muons written again with the current ClassVersion.
+//
+// usage: benchmarkMuonReadRate legacyFile.root [branch] [tree]
+//
+// The branch defaults to the muon collection of a RECO file,
+// recoMuons_muons__RECO.
+
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/Common/interface/Wrapper.h"
+#include "FWCore/FWLite/interface/AutoLibraryLoader.h"
+#include "TFile.h"
+#include "TTree.h"
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+   typedef edm::Wrapper<reco::MuonCollection> MuonWrapper;
+
+   // read all the events; the timed loop only reads and counts, so that
+   // both formats are timed doing the same work
+   double read( TTree* tree, const std::string& branch )
+   {
+      MuonWrapper* muons = 0;
+      tree->SetBranchStatus("*", 0);
+      tree->SetBranchStatus((branch+"*").c_str(), 1);
+      tree->SetBranchAddress(branch.c_str(), &muons);
+
+      unsigned int nMuons = 0;
+      std::clock_t start = std::clock();
+      const Long64_t nEntries = tree->GetEntries();
+      for(Long64_t i = 0; i < nEntries; ++i) {
+	 tree->GetEntry(i);
+	 if (muons->product() != 0) nMuons += muons->product()->size();
+      }
+      const double time = double(std::clock()-start)/CLOCKS_PER_SEC;
+      tree->ResetBranchAddresses();
+      delete muons;
+
+      printf("%-40s: %8lld events, %9u muons, %9lld bytes on disk, %8.1f kevents/s, %8.1f kmuons/s\n",
+	     tree->GetCurrentFile()->GetName(), nEntries, nMuons, tree->GetZipBytes(),
+	     1e-3*nEntries/time, 1e-3*nMuons/time);
+      return nEntries/time;
+   }
+
+   // copy the muons of all the events, outside of the timed reads
+   void collect( TTree* tree, const std::string& branch, std::vector<reco::MuonCollection>& events )
+   {
+      MuonWrapper* muons = 0;
+      tree->SetBranchAddress(branch.c_str(), &muons);
+      const Long64_t nEntries = tree->GetEntries();
+      for(Long64_t i = 0; i < nEntries; ++i) {
+	 tree->GetEntry(i);
+	 if (muons->product() != 0) events.push_back(*muons->product());
+      }
+      tree->ResetBranchAddresses();
+      delete muons;
+   }
+
+   void write( const std::string& fileName, const std::string& treeName, const std::string& branch,
+	       const std::vector<reco::MuonCollection>& events )
+   {
+      TFile file(fileName.c_str(), "RECREATE");
+      TTree tree(treeName.c_str(), treeName.c_str());
+      MuonWrapper* muons = 0;
+      tree.Branch(branch.c_str(), &muons);
+      for(unsigned int i = 0; i < events.size(); ++i) {
+	 std::unique_ptr<reco::MuonCollection> product(new reco::MuonCollection(events[i]));
+	 MuonWrapper wrapper(std::move(product));
+	 muons = &wrapper;
+	 tree.Fill();
+      }
+      tree.Write();
+   }
+}
+
+int main( int argc, char** argv )
+{
+   if (argc < 2) {
+      printf("usage: %s legacyFile.root [branch] [tree]\n", argv[0]);
+      return 1;
+   }
+   AutoLibraryLoader::enable();
+
+   const std::string legacyName = argv[1];
+   const std::string branch = argc > 2 ? argv[2] : "recoMuons_muons__RECO.";
+   const std::string treeName = argc > 3 ? argv[3] : "Events";
+   const std::string currentName = "muonsCurrentFormat.root";
+
+   std::vector<reco::MuonCollection> events;
+   double legacyRate, currentRate;
+   {
+      TFile file(legacyName.c_str());
+      TTree* tree = (TTree*) file.Get(treeName.c_str());
+      if (tree == 0) {
+	 printf("%s has no tree %s\n", legacyName.c_str(), treeName.c_str());
+	 return 1;
+      }
+      read(tree, branch);   // warm up the file cache
+      legacyRate = read(tree, branch);
+      collect(tree, branch, events);
+   }
+
+   write(currentName, treeName, branch, events);
+   {
+      TFile file(currentName.c_str());
+      TTree* tree = (TTree*) file.Get(treeName.c_str());
+      read(tree, branch);
+      currentRate = read(tree, branch);
+   }
+
+   printf("legacy/current read rate: %.2f\n", legacyRate/currentRate);
+   return 0;
+}
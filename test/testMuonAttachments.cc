@@ -0,0 +1,185 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonAttachments.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/Common/interface/TestHandle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <vector>
+
+class testMuonAttachments : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonAttachments);
+  CPPUNIT_TEST(checkIndex);
+  CPPUNIT_TEST(checkFill);
+  CPPUNIT_TEST(checkMissingSource);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown() {}
+  void checkIndex();
+  void checkFill();
+  void checkMissingSource();
+
+private:
+  reco::MuonCollection otherMuons_;
+  reco::MuonCollection muons_;
+  reco::MuonRefProd otherProd_;
+  reco::MuonRefProd prod_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonAttachments);
+
+namespace {
+  // the value of muon i, distinct for each collection and muon
+  float value( unsigned int collection, unsigned int i ) { return 10.f*collection + i + 1; }
+
+  // a map with an entry per muon of each collection, the collections
+  // being inserted in the given order
+  template<typename T, typename F>
+  void fillMap( edm::ValueMap<T>& map, const std::vector<reco::MuonRefProd>& prods, F make )
+  {
+    typename edm::ValueMap<T>::Filler filler(map);
+    for ( unsigned int c = 0; c < prods.size(); ++c ) {
+      std::vector<T> values;
+      for ( unsigned int i = 0; i < prods[c]->size(); ++i ) values.push_back(make(value(prods[c].id().i, i)));
+      edm::TestHandle<reco::MuonCollection> handle(prods[c].product(), prods[c].id());
+      filler.insert(handle, values.begin(), values.end());
+    }
+    filler.fill();
+  }
+
+  reco::MuonQuality quality( float x ) {
+    reco::MuonQuality quality;
+    quality.trkKink = x;
+    quality.glbTrackProbability = -x;
+    return quality;
+  }
+
+  reco::MuonCosmicCompatibility cosmicCompatibility( float x ) {
+    reco::MuonCosmicCompatibility compatibility;
+    compatibility.cosmicCompatibility = x;
+    compatibility.timeCompatibility = 2*x;
+    return compatibility;
+  }
+
+  reco::MuonShower shower( float x ) {
+    reco::MuonShower shower;
+    shower.nStationHits[3] = int(x);
+    shower.stationShowerDeltaR[1] = x;
+    return shower;
+  }
+
+  reco::MuonMETCorrectionData metCorrection( float x ) {
+    return reco::MuonMETCorrectionData(reco::MuonMETCorrectionData::TrackUsed, x, -x);
+  }
+
+  reco::MuonTimeExtra timeExtra( float x ) {
+    reco::MuonTimeExtra time;
+    time.setInverseBeta(x);
+    time.setFreeInverseBeta(-x);
+    return time;
+  }
+}
+
+void testMuonAttachments::setUp()
+{
+  otherMuons_.resize(2);
+  muons_.resize(3);
+  otherProd_ = reco::MuonRefProd(edm::TestHandle<reco::MuonCollection>(&otherMuons_, edm::ProductID(1, 1)));
+  prod_ = reco::MuonRefProd(edm::TestHandle<reco::MuonCollection>(&muons_, edm::ProductID(1, 2)));
+}
+
+void testMuonAttachments::checkIndex()
+{
+  reco::MuonAttachments attachments(prod_, reco::MuonAttachments::Quality);
+  CPPUNIT_ASSERT(attachments.size() == muons_.size());
+  for ( unsigned int i = 0; i < muons_.size(); ++i )
+    CPPUNIT_ASSERT(attachments.index(reco::MuonRef(prod_, i)) == i);
+
+  // a muon of another collection, even with a valid key, and a key
+  // beyond the collection are rejected
+  CPPUNIT_ASSERT_THROW(attachments.index(reco::MuonRef(otherProd_, 0)), cms::Exception);
+  CPPUNIT_ASSERT_THROW(attachments.quality(reco::MuonRef(otherProd_, 1)), cms::Exception);
+  CPPUNIT_ASSERT_THROW(attachments.index(reco::MuonRef(prod_, muons_.size())), cms::Exception);
+}
+
+void testMuonAttachments::checkFill()
+{
+  // the muons are the second collection of the maps, so that their
+  // values do not start at the beginning of the maps
+  std::vector<reco::MuonRefProd> prods;
+  prods.push_back(otherProd_);
+  prods.push_back(prod_);
+  edm::ValueMap<reco::MuonQuality> qualities;
+  edm::ValueMap<reco::MuonCosmicCompatibility> cosmicCompatibilities;
+  edm::ValueMap<reco::MuonShower> showers;
+  edm::ValueMap<reco::MuonMETCorrectionData> metCorrections;
+  edm::ValueMap<reco::MuonTimeExtra> timesDT;
+  fillMap(qualities, prods, quality);
+  fillMap(cosmicCompatibilities, prods, cosmicCompatibility);
+  fillMap(showers, prods, shower);
+  fillMap(metCorrections, prods, metCorrection);
+  fillMap(timesDT, prods, timeExtra);
+
+  muon::MuonAttachmentSources sources;
+  sources.quality = &qualities;
+  sources.cosmicCompatibility = &cosmicCompatibilities;
+  sources.shower = &showers;
+  sources.metCorrection = &metCorrections;
+  sources.timeExtraDT = &timesDT;
+  reco::MuonAttachments attachments;
+  muon::fillMuonAttachments(prod_, sources, attachments);
+
+  CPPUNIT_ASSERT(attachments.muons().id() == prod_.id());
+  CPPUNIT_ASSERT(attachments.size() == muons_.size());
+  CPPUNIT_ASSERT(attachments.blocks() == (reco::MuonAttachments::Quality | reco::MuonAttachments::CosmicCompatibility |
+					  reco::MuonAttachments::Shower | reco::MuonAttachments::METCorrection |
+					  reco::MuonAttachments::TimeDT));
+  CPPUNIT_ASSERT(!attachments.has(reco::MuonAttachments::TimeCombined));
+  CPPUNIT_ASSERT(!attachments.has(reco::MuonAttachments::TimeCSC));
+  CPPUNIT_ASSERT(attachments.timesCombined().empty());
+  CPPUNIT_ASSERT(attachments.timesCSC().empty());
+
+  for ( unsigned int i = 0; i < muons_.size(); ++i ) {
+    const reco::MuonRef muon(prod_, i);
+    const float x = value(prod_.id().i, i);
+    CPPUNIT_ASSERT(attachments.quality(i).trkKink == x);
+    CPPUNIT_ASSERT(attachments.quality(muon).glbTrackProbability == -x);
+    CPPUNIT_ASSERT(attachments.cosmicCompatibility(i).cosmicCompatibility == x);
+    CPPUNIT_ASSERT(attachments.cosmicCompatibility(muon).timeCompatibility == 2*x);
+    CPPUNIT_ASSERT(attachments.shower(i).nStationHits[3] == int(x));
+    CPPUNIT_ASSERT(attachments.shower(muon).stationShowerDeltaR[1] == x);
+    reco::MuonMETCorrectionData correction = attachments.metCorrection(muon);
+    CPPUNIT_ASSERT(correction.type() == reco::MuonMETCorrectionData::TrackUsed);
+    CPPUNIT_ASSERT(correction.corrX() == x && correction.corrY() == -x);
+    CPPUNIT_ASSERT(attachments.timeDT(i).inverseBeta() == x);
+    CPPUNIT_ASSERT(attachments.timeDT(muon).freeInverseBeta() == -x);
+  }
+
+  // an empty collection gives empty blocks
+  reco::MuonCollection noMuons;
+  reco::MuonRefProd noProd(edm::TestHandle<reco::MuonCollection>(&noMuons, edm::ProductID(1, 3)));
+  prods.push_back(noProd);
+  edm::ValueMap<reco::MuonQuality> moreQualities;
+  fillMap(moreQualities, prods, quality);
+  muon::MuonAttachmentSources qualitySource;
+  qualitySource.quality = &moreQualities;
+  muon::fillMuonAttachments(noProd, qualitySource, attachments);
+  CPPUNIT_ASSERT(attachments.size() == 0);
+  CPPUNIT_ASSERT(attachments.has(reco::MuonAttachments::Quality));
+  CPPUNIT_ASSERT(attachments.qualities().empty());
+}
+
+void testMuonAttachments::checkMissingSource()
+{
+  std::vector<reco::MuonRefProd> prods(1, otherProd_);
+  edm::ValueMap<reco::MuonShower> showers;
+  fillMap(showers, prods, shower);
+  muon::MuonAttachmentSources sources;
+  sources.shower = &showers;
+
+  // the attachments are left untouched
+  reco::MuonAttachments attachments(otherProd_, reco::MuonAttachments::Shower);
+  CPPUNIT_ASSERT_THROW(muon::fillMuonAttachments(prod_, sources, attachments), cms::Exception);
+  CPPUNIT_ASSERT(attachments.muons().id() == otherProd_.id());
+  CPPUNIT_ASSERT(attachments.size() == otherMuons_.size());
+}
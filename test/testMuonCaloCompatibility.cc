@@ -0,0 +1,127 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonCaloCompatibility.h"
+#include <cmath>
+#include <limits>
+#include <vector>
+
+class testMuonCaloCompatibility : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonCaloCompatibility);
+  CPPUNIT_TEST(checkBinEdges);
+  CPPUNIT_TEST(checkNaN);
+  CPPUNIT_TEST(checkBatch);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkBinEdges();
+  void checkNaN();
+  void checkBatch();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonCaloCompatibility);
+
+namespace {
+  typedef muon::CaloCompatibilityTemplates Templates;
+
+  // 2 regions split at |eta| = 1.2, 4 momentum bins of 16 GeV from 0 and
+  // 4 energy bins of 2 GeV from 0, exact in binary
+  const unsigned int nP = 4, nEnergy = 4;
+  const float energyMax[Templates::nVariables] = { 8.f, 8.f, 8.f };
+
+  // the muon template value of a bin encodes the bin: 1 + region*100 + pBin*10 + energyBin
+  float muonValue( unsigned int region, unsigned int pBin, unsigned int energyBin ) {
+    return 1.f + region*100.f + pBin*10.f + energyBin;
+  }
+
+  Templates makeTemplates() {
+    std::vector<float> etaEdges;
+    etaEdges.push_back(0.f);
+    etaEdges.push_back(1.2f);
+    etaEdges.push_back(2.4f);
+    Templates templates(etaEdges, nP, 0.f, 64.f, nEnergy, energyMax);
+    float muon[nP*nEnergy], pion[nP*nEnergy];
+    for (unsigned int region = 0; region < 2; ++region)
+      for (int variable = 0; variable < Templates::nVariables; ++variable) {
+        for (unsigned int i = 0; i < nP; ++i)
+          for (unsigned int j = 0; j < nEnergy; ++j) {
+            muon[i*nEnergy+j] = muonValue(region, i, j);
+            // pion values not proportional to the muon ones, with one
+            // bin empty for both
+            pion[i*nEnergy+j] = float((region*7 + variable*5 + i*3 + j*11) % 13)/13.f;
+          }
+        if (region == 1 && variable == Templates::Had) muon[0] = pion[0] = 0.f;
+        templates.setTemplate(Templates::MuonHypothesis, Templates::Variable(variable), region, muon);
+        templates.setTemplate(Templates::PionHypothesis, Templates::Variable(variable), region, pion);
+      }
+    return templates;
+  }
+
+  float muonProbability( const Templates& templates, float p, float eta, float energy ) {
+    return templates.probability(Templates::MuonHypothesis, Templates::EM, p, eta, energy);
+  }
+}
+
+void testMuonCaloCompatibility::checkBinEdges() {
+  const Templates templates = makeTemplates();
+  // a value on a bin edge belongs to the upper bin
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 1, 0), muonProbability(templates, 16.f, 0.5f, 0.f));
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 0, 0), muonProbability(templates, 15.999f, 0.5f, 0.f));
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 0, 2), muonProbability(templates, 1.f, 0.5f, 4.f));
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 0, 1), muonProbability(templates, 1.f, 0.5f, 3.999f));
+  CPPUNIT_ASSERT_EQUAL(1u, templates.region(1.2f));
+  CPPUNIT_ASSERT_EQUAL(0u, templates.region(1.1999f));
+  // outside of the ranges: the edge bins
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 0, 0), muonProbability(templates, -5.f, 0.5f, -1.f));
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 3, 3), muonProbability(templates, 64.f, 0.5f, 8.f));
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 3, 3), muonProbability(templates, 1e30f, 0.5f, 1e30f));
+  CPPUNIT_ASSERT_EQUAL(0u, templates.region(-3.f));
+  CPPUNIT_ASSERT_EQUAL(1u, templates.region(5.f));
+  const float infinity = std::numeric_limits<float>::infinity();
+  CPPUNIT_ASSERT_EQUAL(muonValue(1, 3, 0), muonProbability(templates, infinity, infinity, -infinity));
+}
+
+void testMuonCaloCompatibility::checkNaN() {
+  const Templates templates = makeTemplates();
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  CPPUNIT_ASSERT_EQUAL(muonValue(0, 0, 0), muonProbability(templates, nan, nan, nan));
+  CPPUNIT_ASSERT_EQUAL(muonValue(1, 2, 0), muonProbability(templates, 40.f, 2.f, nan));
+  const float energies[Templates::nVariables] = { nan, nan, nan };
+  const float compatibility = templates.compatibility(nan, nan, energies);
+  CPPUNIT_ASSERT(compatibility >= 0.f && compatibility <= 1.f);
+}
+
+void testMuonCaloCompatibility::checkBatch() {
+  Templates templates = makeTemplates();
+  templates.setMinimumProbability(1e-3f);
+  // more tracks than a block, covering all the bins, the empty one and
+  // values outside of the ranges
+  const unsigned int n = 150;
+  std::vector<float> p(n), eta(n), energies[Templates::nVariables];
+  for (int variable = 0; variable < Templates::nVariables; ++variable) energies[variable].resize(n);
+  for (unsigned int i = 0; i < n; ++i) {
+    p[i] = -4.f + 0.5f*i;
+    eta[i] = -0.3f + 0.02f*i;
+    energies[Templates::EM][i] = 0.07f*i;
+    energies[Templates::Had][i] = (i % 5 == 0) ? 0.5f : 0.11f*(n-i);
+    energies[Templates::HO][i] = -1.f + 0.05f*i;
+  }
+  std::vector<float> result(n);
+  const float* energy[Templates::nVariables] = { &energies[0][0], &energies[1][0], &energies[2][0] };
+  templates.compatibilities(&p[0], &eta[0], energy, n, &result[0]);
+
+  for (unsigned int i = 0; i < n; ++i) {
+    // the same track alone
+    const float trackEnergies[Templates::nVariables] = { energies[0][i], energies[1][i], energies[2][i] };
+    CPPUNIT_ASSERT_EQUAL(templates.compatibility(p[i], eta[i], trackEnergies), result[i]);
+
+    // the likelihoods from the scalar probability lookups
+    double muonLikelihood = 1., pionLikelihood = 1.;
+    for (int variable = 0; variable < Templates::nVariables; ++variable) {
+      muonLikelihood *= templates.probability(Templates::MuonHypothesis, Templates::Variable(variable), p[i], eta[i], energies[variable][i]);
+      pionLikelihood *= templates.probability(Templates::PionHypothesis, Templates::Variable(variable), p[i], eta[i], energies[variable][i]);
+    }
+    const double expected = muonLikelihood + pionLikelihood > 0 ? muonLikelihood/(muonLikelihood + pionLikelihood) : 0.5;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, result[i], 1e-6);
+  }
+}
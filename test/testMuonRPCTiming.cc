@@ -0,0 +1,107 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonRPCTiming.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/MuonDetId/interface/RPCDetId.h"
+#include <vector>
+
+class testMuonRPCTiming : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonRPCTiming);
+  CPPUNIT_TEST(checkNoHits);
+  CPPUNIT_TEST(checkMajorityTies);
+  CPPUNIT_TEST(checkEdgeBins);
+  CPPUNIT_TEST(checkCollection);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkNoHits();
+  void checkMajorityTies();
+  void checkEdgeBins();
+  void checkCollection();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonRPCTiming);
+
+namespace {
+  // a muon with one RPC hit at each of the given BX, in barrel
+  // station 1, layer 1 (RPC layer 1)
+  reco::Muon muonWithHits( const int* bx, unsigned int n ) {
+    reco::MuonChamberMatch chamber;
+    chamber.id = RPCDetId(0, 0, 1, 1, 1, 1, 1);
+    for (unsigned int i = 0; i < n; ++i) {
+      reco::MuonRPCHitMatch hit;
+      hit.bx = bx[i];
+      chamber.rpcMatches.push_back(hit);
+    }
+    reco::Muon muon;
+    muon.setMatches(std::vector<reco::MuonChamberMatch>(1, chamber));
+    return muon;
+  }
+
+  int majorityBX( const int* bx, unsigned int n ) {
+    return muon::rpcTiming(muonWithHits(bx, n)).majorityBX;
+  }
+}
+
+void testMuonRPCTiming::checkNoHits() {
+  muon::MuonRPCTiming timing = muon::rpcTiming(reco::Muon());
+  CPPUNIT_ASSERT_EQUAL((unsigned short)0, timing.nHits);
+  CPPUNIT_ASSERT_EQUAL(0, timing.majorityBX);
+  CPPUNIT_ASSERT_EQUAL(0.f, timing.spreadBX);
+  CPPUNIT_ASSERT_EQUAL(0, timing.numberOfLayers());
+  CPPUNIT_ASSERT(!timing.isOutOfTime(0));
+}
+
+void testMuonRPCTiming::checkMajorityTies() {
+  // ties go to the BX closest to 0, then to the earlier one
+  const int zeroAndTwo[2] = { 2, 0 };
+  CPPUNIT_ASSERT_EQUAL(0, majorityBX(zeroAndTwo, 2));
+  const int oneAndTwo[4] = { 2, 1, 2, 1 };
+  CPPUNIT_ASSERT_EQUAL(1, majorityBX(oneAndTwo, 4));
+  const int plusMinusOne[2] = { 1, -1 };
+  CPPUNIT_ASSERT_EQUAL(-1, majorityBX(plusMinusOne, 2));
+  const int plusMinusTwo[4] = { 2, -2, -2, 2 };
+  CPPUNIT_ASSERT_EQUAL(-2, majorityBX(plusMinusTwo, 4));
+  // a strict majority wins whatever its distance to 0
+  const int mostlyLate[3] = { 0, 3, 3 };
+  CPPUNIT_ASSERT_EQUAL(3, majorityBX(mostlyLate, 3));
+
+  muon::MuonRPCTiming timing = muon::rpcTiming(muonWithHits(mostlyLate, 3));
+  CPPUNIT_ASSERT(timing.isOutOfTime(2));
+  CPPUNIT_ASSERT(!timing.isOutOfTime(4));
+  CPPUNIT_ASSERT_EQUAL(1, timing.numberOfInTimeLayers());
+}
+
+void testMuonRPCTiming::checkEdgeBins() {
+  // hits beyond the histogram range go to the first and last bins, the
+  // mean and spread use their true BX
+  const int bx[3] = { -7, 5, 6 };
+  muon::MuonRPCTiming timing = muon::rpcTiming(muonWithHits(bx, 3));
+  CPPUNIT_ASSERT_EQUAL((unsigned short)3, timing.nHits);
+  CPPUNIT_ASSERT_EQUAL((unsigned short)1, timing.hitsAtBX(muon::MuonRPCTiming::minBX));
+  CPPUNIT_ASSERT_EQUAL((unsigned short)2, timing.hitsAtBX(muon::MuonRPCTiming::maxBX));
+  CPPUNIT_ASSERT_EQUAL((unsigned short)0, timing.hitsAtBX(-7));
+  CPPUNIT_ASSERT_EQUAL((unsigned short)0, timing.hitsAtBX(5));
+  CPPUNIT_ASSERT_EQUAL(int(muon::MuonRPCTiming::maxBX), timing.majorityBX);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4./3., timing.meanBX, 1e-6);
+  CPPUNIT_ASSERT_EQUAL(0, timing.numberOfInTimeLayers());
+  CPPUNIT_ASSERT_EQUAL(1, timing.numberOfLayers());
+
+  // one overflow on each side: a tie between the edge bins
+  const int both[2] = { 4, -4 };
+  CPPUNIT_ASSERT_EQUAL(int(muon::MuonRPCTiming::minBX), majorityBX(both, 2));
+}
+
+void testMuonRPCTiming::checkCollection() {
+  const int inTime[2] = { 0, 0 };
+  const int late[2] = { 1, 1 };
+  reco::MuonCollection muons;
+  muons.push_back(muonWithHits(inTime, 2));
+  muons.push_back(muonWithHits(late, 2));
+  muons.push_back(reco::Muon());
+  std::vector<muon::MuonRPCTiming> timings;
+  CPPUNIT_ASSERT_EQUAL(1u, muon::fillRPCTimings(muons, timings));
+  CPPUNIT_ASSERT_EQUAL(size_t(3), timings.size());
+  CPPUNIT_ASSERT_EQUAL(1, timings[1].majorityBX);
+}
@@ -0,0 +1,131 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonShowerTagger.h"
+#include <cmath>
+#include <vector>
+
+class testMuonShowerTagger : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonShowerTagger);
+  CPPUNIT_TEST(checkStation);
+  CPPUNIT_TEST(checkNegativeDeltaT);
+  CPPUNIT_TEST(checkEmptyStations);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkStation();
+  void checkNegativeDeltaT();
+  void checkEmptyStations();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonShowerTagger);
+
+namespace {
+  const unsigned int nStations = reco::MuonShower::nStations;
+
+  // hits of several muons, appended station by station
+  struct Hits {
+    std::vector<float> deltaEta, deltaPhi, deltaT;
+    std::vector<uint8_t> correlated;
+    std::vector<unsigned int> offsets;
+
+    Hits() { offsets.push_back(0); }
+    void add( float eta, float phi, float t, bool used ) {
+      deltaEta.push_back(eta); deltaPhi.push_back(phi); deltaT.push_back(t); correlated.push_back(used);
+    }
+    void endStation() { offsets.push_back(deltaT.size()); }
+
+    muon::MuonShowerHits hits() const {
+      muon::MuonShowerHits result;
+      if (!deltaT.empty()) {
+        result.deltaEta = &deltaEta[0];
+        result.deltaPhi = &deltaPhi[0];
+        result.deltaT = &deltaT[0];
+        result.correlated = &correlated[0];
+      }
+      result.offsets = &offsets[0];
+      return result;
+    }
+  };
+
+  void checkEmpty( const reco::MuonShower& shower, unsigned int station ) {
+    CPPUNIT_ASSERT_EQUAL(0, shower.nStationHits[station]);
+    CPPUNIT_ASSERT_EQUAL(0, shower.nStationCorrelatedHits[station]);
+    CPPUNIT_ASSERT_EQUAL(0.f, shower.stationShowerSizeT[station]);
+    CPPUNIT_ASSERT_EQUAL(0.f, shower.stationShowerDeltaR[station]);
+  }
+}
+
+void testMuonShowerTagger::checkStation() {
+  Hits hits;
+  hits.add(0.03f, 0.04f, 1.5f, true);
+  hits.add(-0.01f, 0.f, 4.f, false);
+  hits.add(0.f, -0.02f, 2.f, true);
+  hits.endStation();
+  for (unsigned int s = 1; s < nStations; ++s) hits.endStation();
+
+  reco::MuonShower shower = muon::muonShower(hits.hits());
+  CPPUNIT_ASSERT_EQUAL(3, shower.nStationHits[0]);
+  CPPUNIT_ASSERT_EQUAL(2, shower.nStationCorrelatedHits[0]);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, shower.stationShowerSizeT[0], 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.05, shower.stationShowerDeltaR[0], 1e-6);
+}
+
+void testMuonShowerTagger::checkNegativeDeltaT() {
+  Hits hits;
+  // hits on both sides of the trajectory
+  hits.add(0.f, 0.f, -3.f, false);
+  hits.add(0.f, 0.f, 2.f, false);
+  hits.add(0.f, 0.f, -1.f, false);
+  hits.endStation();
+  // all on the negative side
+  hits.add(0.f, 0.f, -5.f, false);
+  hits.add(0.f, 0.f, -2.f, false);
+  hits.endStation();
+  // both signs of zero
+  hits.add(0.f, 0.f, -0.f, false);
+  hits.add(0.f, 0.f, 0.f, false);
+  hits.endStation();
+  // a single hit
+  hits.add(0.f, 0.f, -7.f, false);
+  hits.endStation();
+
+  reco::MuonShower shower = muon::muonShower(hits.hits());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5., shower.stationShowerSizeT[0], 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3., shower.stationShowerSizeT[1], 1e-6);
+  CPPUNIT_ASSERT_EQUAL(0.f, shower.stationShowerSizeT[2]);
+  CPPUNIT_ASSERT_EQUAL(0.f, shower.stationShowerSizeT[3]);
+  CPPUNIT_ASSERT_EQUAL(1, shower.nStationHits[3]);
+  CPPUNIT_ASSERT_EQUAL(0.f, shower.stationShowerDeltaR[3]);
+}
+
+void testMuonShowerTagger::checkEmptyStations() {
+  Hits hits;
+  // muon 0: stations 1 and 3 empty
+  hits.endStation();
+  hits.add(0.1f, 0.f, -1.f, true);
+  hits.add(0.f, 0.f, 1.f, true);
+  hits.endStation();
+  hits.endStation();
+  hits.add(0.f, 0.f, 0.5f, false);
+  hits.endStation();
+  // muon 1: no hit at all
+  for (unsigned int s = 0; s < nStations; ++s) hits.endStation();
+
+  std::vector<reco::MuonShower> showers;
+  muon::fillMuonShowers(hits.hits(), 2, showers);
+  CPPUNIT_ASSERT_EQUAL(size_t(2), showers.size());
+  checkEmpty(showers[0], 0);
+  checkEmpty(showers[0], 2);
+  CPPUNIT_ASSERT_EQUAL(2, showers[0].nStationHits[1]);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(2., showers[0].stationShowerSizeT[1], 1e-6);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(0.1, showers[0].stationShowerDeltaR[1], 1e-6);
+  CPPUNIT_ASSERT_EQUAL(1, showers[0].nStationHits[3]);
+  for (unsigned int s = 0; s < nStations; ++s) checkEmpty(showers[1], s);
+
+  // no hits in the whole event
+  Hits none;
+  for (unsigned int s = 0; s < nStations; ++s) none.endStation();
+  reco::MuonShower shower = muon::muonShower(none.hits());
+  for (unsigned int s = 0; s < nStations; ++s) checkEmpty(shower, s);
+}
@@ -0,0 +1,327 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonSnapshot.h"
+#include "DataFormats/MuonReco/interface/MuonSelectors.h"
+#include "DataFormats/MuonReco/interface/MuonTrackTable.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/VertexReco/interface/Vertex.h"
+#include "DataFormats/MuonDetId/interface/DTChamberId.h"
+#include "DataFormats/MuonDetId/interface/CSCDetId.h"
+#include "DataFormats/Common/interface/TestHandle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class testMuonSnapshot : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonSnapshot);
+  CPPUNIT_TEST(checkRoundTrip);
+  CPPUNIT_TEST(checkSelectors);
+  CPPUNIT_TEST(checkCorruptFiles);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown();
+  void checkRoundTrip();
+  void checkSelectors();
+  void checkCorruptFiles();
+
+private:
+  reco::TrackCollection tracks_;
+  reco::MuonCollection muons_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonSnapshot);
+
+namespace {
+  const char* const fileName = "testMuonSnapshot.snap";
+  const char* const corruptFileName = "testMuonSnapshotCorrupt.snap";
+
+  reco::Track track( double px, double py, double pz, double chi2, double ndof ) {
+    return reco::Track(chi2, ndof, reco::TrackBase::Point(0.01, -0.02, 0.5),
+		       reco::TrackBase::Vector(px, py, pz), 1, reco::TrackBase::CovarianceMatrix());
+  }
+
+  reco::MuonSegmentMatch segment( float x, unsigned int mask ) {
+    reco::MuonSegmentMatch match;
+    match.x = x;
+    match.y = -x;
+    match.xErr = 0.1f;
+    match.yErr = 0.2f;
+    match.dXdZ = 0.05f;
+    match.dYdZ = -0.03f;
+    match.dXdZErr = 0.01f;
+    match.dYdZErr = 0.02f;
+    match.t0 = 1.5f;
+    match.mask = mask;
+    match.hasZed_ = true;
+    match.hasPhi_ = false;
+    return match;
+  }
+
+  reco::MuonChamberMatch chamber( const DetId& id, float x ) {
+    reco::MuonChamberMatch match;
+    match.id = id;
+    match.edgeX = -5.f;
+    match.edgeY = -3.f;
+    match.x = x;
+    match.y = 2.f*x;
+    match.xErr = 0.3f;
+    match.yErr = 0.4f;
+    match.dXdZ = 0.1f;
+    match.dYdZ = 0.2f;
+    match.dXdZErr = 0.01f;
+    match.dYdZErr = 0.02f;
+    return match;
+  }
+
+  std::string readFile( const char* name ) {
+    std::ifstream file(name, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  void writeFile( const char* name, const std::string& content ) {
+    std::ofstream file(name, std::ios::binary);
+    file.write(content.data(), content.size());
+  }
+
+  bool opens( const std::string& content ) {
+    writeFile(corruptFileName, content);
+    try {
+      muon::MuonSnapshot snapshot(corruptFileName);
+    } catch ( cms::Exception& ) {
+      return false;
+    }
+    return true;
+  }
+
+  void checkSameMatches( const std::vector<reco::MuonChamberMatch>& expected,
+			 const std::vector<reco::MuonChamberMatch>& matches ) {
+    CPPUNIT_ASSERT_EQUAL(expected.size(), matches.size());
+    for ( unsigned int i = 0; i < expected.size(); ++i ) {
+      const reco::MuonChamberMatch& e = expected[i];
+      const reco::MuonChamberMatch& m = matches[i];
+      CPPUNIT_ASSERT(e.id == m.id);
+      CPPUNIT_ASSERT(e.edgeX == m.edgeX && e.edgeY == m.edgeY && e.x == m.x && e.y == m.y);
+      CPPUNIT_ASSERT(e.xErr == m.xErr && e.yErr == m.yErr && e.dXdZ == m.dXdZ && e.dYdZ == m.dYdZ);
+      CPPUNIT_ASSERT(e.dXdZErr == m.dXdZErr && e.dYdZErr == m.dYdZErr);
+      CPPUNIT_ASSERT_EQUAL(e.segmentMatches.size(), m.segmentMatches.size());
+      for ( unsigned int j = 0; j < e.segmentMatches.size(); ++j ) {
+	const reco::MuonSegmentMatch& es = e.segmentMatches[j];
+	const reco::MuonSegmentMatch& ms = m.segmentMatches[j];
+	CPPUNIT_ASSERT(es.x == ms.x && es.y == ms.y && es.xErr == ms.xErr && es.yErr == ms.yErr);
+	CPPUNIT_ASSERT(es.dXdZ == ms.dXdZ && es.dYdZ == ms.dYdZ && es.dXdZErr == ms.dXdZErr && es.dYdZErr == ms.dYdZErr);
+	CPPUNIT_ASSERT(es.t0 == ms.t0 && es.mask == ms.mask && es.hasZed_ == ms.hasZed_ && es.hasPhi_ == ms.hasPhi_);
+      }
+      CPPUNIT_ASSERT_EQUAL(e.rpcMatches.size(), m.rpcMatches.size());
+      for ( unsigned int j = 0; j < e.rpcMatches.size(); ++j )
+	CPPUNIT_ASSERT(e.rpcMatches[j].x == m.rpcMatches[j].x && e.rpcMatches[j].mask == m.rpcMatches[j].mask &&
+		       e.rpcMatches[j].bx == m.rpcMatches[j].bx);
+    }
+  }
+
+  void checkSameIsolation( const reco::MuonPFIsolation& e, const reco::MuonPFIsolation& m ) {
+    CPPUNIT_ASSERT(e.sumChargedHadronPt == m.sumChargedHadronPt && e.sumChargedParticlePt == m.sumChargedParticlePt);
+    CPPUNIT_ASSERT(e.sumNeutralHadronEt == m.sumNeutralHadronEt && e.sumPhotonEt == m.sumPhotonEt);
+    CPPUNIT_ASSERT(e.sumNeutralHadronEtHighThreshold == m.sumNeutralHadronEtHighThreshold);
+    CPPUNIT_ASSERT(e.sumPhotonEtHighThreshold == m.sumPhotonEtHighThreshold && e.sumPUPt == m.sumPUPt);
+  }
+
+  void checkSameMuon( const reco::Muon& expected, const reco::Muon& muon ) {
+    CPPUNIT_ASSERT(expected.px() == muon.px() && expected.py() == muon.py() && expected.pz() == muon.pz());
+    CPPUNIT_ASSERT_EQUAL(expected.energy(), muon.energy());
+    CPPUNIT_ASSERT(expected.vx() == muon.vx() && expected.vy() == muon.vy() && expected.vz() == muon.vz());
+    CPPUNIT_ASSERT_EQUAL(expected.charge(), muon.charge());
+    CPPUNIT_ASSERT_EQUAL(expected.type(), muon.type());
+    CPPUNIT_ASSERT_EQUAL(expected.muonBestTrackType(), muon.muonBestTrackType());
+    CPPUNIT_ASSERT_EQUAL(expected.tunePMuonBestTrackType(), muon.tunePMuonBestTrackType());
+    CPPUNIT_ASSERT_EQUAL(expected.caloCompatibility(), muon.caloCompatibility());
+
+    CPPUNIT_ASSERT_EQUAL(expected.isIsolationValid(), muon.isIsolationValid());
+    CPPUNIT_ASSERT_EQUAL(expected.isolationR03().sumPt, muon.isolationR03().sumPt);
+    CPPUNIT_ASSERT_EQUAL(expected.isolationR05().nTracks, muon.isolationR05().nTracks);
+    CPPUNIT_ASSERT_EQUAL(expected.isPFIsolationValid(), muon.isPFIsolationValid());
+    CPPUNIT_ASSERT_EQUAL(expected.numberOfPFIsolations(), muon.numberOfPFIsolations());
+    for ( unsigned int type = 0; type < expected.numberOfPFIsolations(); ++type )
+      checkSameIsolation(expected.pfIsolation(reco::Muon::PFIsolationType(type)),
+			 muon.pfIsolation(reco::Muon::PFIsolationType(type)));
+
+    CPPUNIT_ASSERT_EQUAL(expected.isQualityValid(), muon.isQualityValid());
+    CPPUNIT_ASSERT_EQUAL(expected.combinedQuality().trkKink, muon.combinedQuality().trkKink);
+    CPPUNIT_ASSERT_EQUAL(expected.combinedQuality().chi2LocalPosition, muon.combinedQuality().chi2LocalPosition);
+    CPPUNIT_ASSERT_EQUAL(expected.time().nDof, muon.time().nDof);
+    CPPUNIT_ASSERT_EQUAL(expected.time().timeAtIpInOut, muon.time().timeAtIpInOut);
+    CPPUNIT_ASSERT_EQUAL(expected.time().timeAtIpOutInErr, muon.time().timeAtIpOutInErr);
+
+    CPPUNIT_ASSERT_EQUAL(expected.isMatchesValid(), muon.isMatchesValid());
+    checkSameMatches(expected.matches(), muon.matches());
+  }
+}
+
+void testMuonSnapshot::setUp() {
+  tracks_.clear();
+  tracks_.push_back(track(30., 40., 20., 12., 10.));    // inner
+  tracks_.push_back(track(31., 39., 21., 25., 20.));    // outer
+  tracks_.push_back(track(30.5, 40.5, 20.5, 40., 35.)); // global
+  tracks_.push_back(track(3., -4., 1., 8., 9.));        // inner of the tracker muon
+  edm::TestHandle<reco::TrackCollection> handle(&tracks_, edm::ProductID(1, 1));
+
+  muons_.clear();
+
+  // a global muon with everything set
+  reco::Muon global(-1, reco::Muon::LorentzVector(30., 40., 20., 54.), reco::Muon::Point(0.01, -0.02, 0.5));
+  global.setInnerTrack(reco::TrackRef(handle, 0));
+  global.setOuterTrack(reco::TrackRef(handle, 1));
+  global.setGlobalTrack(reco::TrackRef(handle, 2));
+  global.setBestTrack(reco::Muon::CombinedTrack);
+  global.setTunePBestTrack(reco::Muon::InnerTrack);
+  global.setType(reco::Muon::GlobalMuon | reco::Muon::TrackerMuon | reco::Muon::PFMuon);
+  global.setCaloCompatibility(0.8f);
+  reco::MuonIsolation isolation;
+  isolation.sumPt = 1.5f;
+  isolation.nTracks = 2;
+  global.setIsolation(isolation, isolation);
+  reco::MuonPFIsolation pfIsolations[reco::Muon::nPFIsolationTypes];
+  for ( int type = 0; type < reco::Muon::nPFIsolationTypes; ++type ) {
+    pfIsolations[type].sumChargedHadronPt = 0.5f*type;
+    pfIsolations[type].sumPUPt = 2.f + type;
+  }
+  global.setPFIsolations(pfIsolations);
+  reco::MuonQuality quality;
+  quality.trkKink = 12.f;
+  quality.chi2LocalPosition = 3.f;
+  global.setCombinedQuality(quality);
+  reco::MuonTime time;
+  time.nDof = 4;
+  time.timeAtIpInOut = 1.25f;
+  time.timeAtIpOutInErr = 2.5f;
+  global.setTime(time);
+  std::vector<reco::MuonChamberMatch> matches;
+  matches.push_back(chamber(DTChamberId(1, 1, 4), 1.f));
+  matches.back().segmentMatches.push_back(segment(1.1f, reco::MuonSegmentMatch::BestInChamberByDR |
+						       reco::MuonSegmentMatch::BelongsToTrackByDR));
+  matches.back().segmentMatches.push_back(segment(0.7f, 0));
+  reco::MuonRPCHitMatch hit;
+  hit.x = 0.9f;
+  hit.mask = 0;
+  hit.bx = -1;
+  matches.back().rpcMatches.push_back(hit);
+  matches.push_back(chamber(DTChamberId(1, 2, 4), 2.f));
+  matches.back().segmentMatches.push_back(segment(2.2f, reco::MuonSegmentMatch::BestInChamberByDR |
+						       reco::MuonSegmentMatch::BelongsToTrackByDR));
+  matches.push_back(chamber(CSCDetId(1, 2, 1, 10), 3.f));
+  global.setMatches(matches);
+  muons_.push_back(global);
+
+  // a tracker muon with one empty chamber and no isolation
+  reco::Muon tracker(1, reco::Muon::LorentzVector(3., -4., 1., 5.2));
+  tracker.setInnerTrack(reco::TrackRef(handle, 3));
+  tracker.setBestTrack(reco::Muon::InnerTrack);
+  tracker.setType(reco::Muon::TrackerMuon);
+  tracker.setMatches(std::vector<reco::MuonChamberMatch>(1, chamber(DTChamberId(-2, 1, 7), -1.f)));
+  muons_.push_back(tracker);
+
+  // a stand-alone muon without matches
+  reco::Muon standAlone(1, reco::Muon::LorentzVector(31., 39., 21., 54.));
+  standAlone.setOuterTrack(reco::TrackRef(handle, 1));
+  standAlone.setBestTrack(reco::Muon::OuterTrack);
+  standAlone.setType(reco::Muon::StandAloneMuon);
+  muons_.push_back(standAlone);
+
+  muon::MuonSnapshotWriter writer;
+  writer.addEvent(muons_);
+  writer.addEvent(reco::MuonCollection());
+  writer.addEvent(reco::MuonCollection(muons_.begin()+1, muons_.end()));
+  writer.write(fileName);
+}
+
+void testMuonSnapshot::tearDown() {
+  std::remove(fileName);
+  std::remove(corruptFileName);
+}
+
+void testMuonSnapshot::checkRoundTrip() {
+  muon::MuonSnapshot snapshot(fileName);
+  CPPUNIT_ASSERT_EQUAL(3u, snapshot.numberOfEvents());
+  CPPUNIT_ASSERT_EQUAL(5u, snapshot.numberOfMuons());
+  CPPUNIT_ASSERT_EQUAL(0u, snapshot.firstMuon(0));
+  CPPUNIT_ASSERT_EQUAL(3u, snapshot.firstMuon(1));
+  CPPUNIT_ASSERT_EQUAL(3u, snapshot.firstMuon(2));
+  CPPUNIT_ASSERT_EQUAL(5u, snapshot.firstMuon(3));
+
+  const unsigned int original[5] = { 0, 1, 2, 1, 2 };
+  for ( unsigned int i = 0; i < snapshot.numberOfMuons(); ++i ) {
+    const reco::Muon& expected = muons_[original[i]];
+    reco::Muon muon;
+    snapshot.fillMuon(i, muon);
+    checkSameMuon(expected, muon);
+
+    std::vector<reco::MuonChamberMatch> matches;
+    snapshot.fillMatches(i, matches);
+    checkSameMatches(expected.matches(), matches);
+  }
+}
+
+void testMuonSnapshot::checkSelectors() {
+  muon::MuonSnapshot snapshot(fileName);
+  const reco::Vertex vertex;
+  for ( unsigned int i = 0; i < muons_.size(); ++i ) {
+    muon::MuonTrackRow row;
+    muon::fillMuonTrackRow(muons_[i], row);
+    reco::Muon replayed;
+    snapshot.fillMuon(i, replayed);
+    const muon::MuonSnapshotRow replayedRow = snapshot.trackRow(i);
+
+    for ( int type = muon::All; type <= muon::RPCMuLoose; ++type ) {
+      const muon::SelectionType selection = muon::SelectionType(type);
+      CPPUNIT_ASSERT_EQUAL(muon::isGoodMuon(muons_[i], row, selection),
+			   muon::isGoodMuon(replayed, replayedRow, selection));
+    }
+    CPPUNIT_ASSERT_EQUAL(muon::isTightMuon(muons_[i], row, vertex), muon::isTightMuon(replayed, replayedRow, vertex));
+    CPPUNIT_ASSERT_EQUAL(muon::isSoftMuon(muons_[i], row, vertex), muon::isSoftMuon(replayed, replayedRow, vertex));
+    CPPUNIT_ASSERT_EQUAL(muon::isHighPtMuon(muons_[i], row, vertex), muon::isHighPtMuon(replayed, replayedRow, vertex));
+  }
+}
+
+void testMuonSnapshot::checkCorruptFiles() {
+  const std::string content = readFile(fileName);
+  CPPUNIT_ASSERT(opens(content));
+
+  std::string badMagic(content);
+  badMagic[0] = 'X';
+  CPPUNIT_ASSERT(!opens(badMagic));
+
+  muon::MuonSnapshotHeader header;
+  std::memcpy(&header, content.data(), sizeof(header));
+  header.version += 1;
+  std::string badVersion(content);
+  std::memcpy(&badVersion[0], &header, sizeof(header));
+  CPPUNIT_ASSERT(!opens(badVersion));
+
+  CPPUNIT_ASSERT(!opens(content.substr(0, content.size()-1)));
+  CPPUNIT_ASSERT(!opens(content.substr(0, sizeof(header)-1)));
+
+  // muon ranges beyond the sections are only found when read
+  std::memcpy(&header, content.data(), sizeof(header));
+  const size_t recordOffset = header.offsets[muon::MuonSnapshotHeader::Muons];
+  const uint32_t fields[3] = { header.nChambers, header.nSegments, header.nRPCHits };
+  for ( int field = 0; field < 3; ++field ) {
+    muon::MuonSnapshotRecord record;
+    std::memcpy(&record, content.data()+recordOffset, sizeof(record));
+    if ( field == 0 ) record.firstChamber = fields[field];
+    if ( field == 1 ) record.firstSegment = fields[field];
+    if ( field == 2 ) record.firstRPCHit = fields[field];
+    std::string badRecord(content);
+    std::memcpy(&badRecord[recordOffset], &record, sizeof(record));
+    writeFile(corruptFileName, badRecord);
+    muon::MuonSnapshot snapshot(corruptFileName);
+    std::vector<reco::MuonChamberMatch> matches;
+    CPPUNIT_ASSERT_THROW(snapshot.fillMatches(0, matches), cms::Exception);
+    reco::Muon muon;
+    CPPUNIT_ASSERT_THROW(snapshot.fillMuon(0, muon), cms::Exception);
+    snapshot.fillMatches(1, matches);
+  }
+}
@@ -0,0 +1,251 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonTimeClassifier.h"
+#include "DataFormats/MuonReco/interface/Muon.h"
+#include "DataFormats/Common/interface/TestHandle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <cmath>
+#include <vector>
+
+class testMuonTimeClassifier : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonTimeClassifier);
+  CPPUNIT_TEST(checkCases);
+  CPPUNIT_TEST(checkDirection);
+  CPPUNIT_TEST(checkLargeCollection);
+  CPPUNIT_TEST(checkInputs);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkCases();
+  void checkDirection();
+  void checkLargeCollection();
+  void checkInputs();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonTimeClassifier);
+
+namespace {
+  reco::MuonTime muonTime( int nDof, float timeAtIp, float inOutErr, float outInErr,
+			   float inverseBeta, float inverseBetaErr ) {
+    reco::MuonTime time;
+    time.nDof = nDof;
+    time.timeAtIpInOut = timeAtIp;
+    time.timeAtIpInOutErr = inOutErr;
+    time.timeAtIpOutIn = -timeAtIp;
+    time.timeAtIpOutInErr = outInErr;
+    time.setInverseBeta(inverseBeta);
+    time.setInverseBetaErr(inverseBetaErr);
+    return time;
+  }
+
+  // the classification written plainly, muon by muon
+  struct Expected {
+    int direction;
+    float pull;
+    unsigned int flags;
+
+    Expected( const reco::MuonTime& time, const muon::MuonTimeClassifierParameters& parameters ):
+      direction(0), pull(0), flags(0) {
+      if ( time.nDof < parameters.minNDof ) return;
+      flags |= muon::MuonTimeClasses::Measured;
+      direction = 1;
+      if ( time.timeAtIpInOutErr > time.timeAtIpOutInErr ) {
+	direction = -1;
+	flags |= muon::MuonTimeClasses::OutsideIn;
+      }
+      if ( std::fabs(time.timeAtIpInOut) > parameters.maxTimeAtIp ) flags |= muon::MuonTimeClasses::OutOfTime;
+      if ( time.inverseBetaErr() > 0 ) pull = (time.inverseBeta() - 1)/time.inverseBetaErr();
+      if ( std::fabs(pull) > parameters.maxInverseBetaPull ) flags |= muon::MuonTimeClasses::NotRelativistic;
+    }
+  };
+
+  void check( const std::vector<reco::MuonTime>& times, const muon::MuonTimeClasses& classes,
+	      const muon::MuonTimeEventSummary& summary,
+	      const muon::MuonTimeClassifierParameters& parameters = muon::MuonTimeClassifierParameters() ) {
+    CPPUNIT_ASSERT(classes.size() == times.size());
+    CPPUNIT_ASSERT(summary.nMuons == times.size());
+    unsigned int nMeasured = 0, nOutsideIn = 0, nOutOfTime = 0, nNotRelativistic = 0, nInTime = 0;
+    for ( unsigned int i = 0; i < times.size(); ++i ) {
+      const Expected expected(times[i], parameters);
+      CPPUNIT_ASSERT(classes.direction[i] == expected.direction);
+      CPPUNIT_ASSERT(classes.flags[i] == expected.flags);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected.pull, classes.inverseBetaPull[i], 1e-6*std::fabs(expected.pull));
+      // never a -0, and never a nan
+      CPPUNIT_ASSERT(classes.inverseBetaPull[i] != 0 || !std::signbit(classes.inverseBetaPull[i]));
+      nMeasured += classes.isFlag(i, muon::MuonTimeClasses::Measured);
+      nOutsideIn += classes.isFlag(i, muon::MuonTimeClasses::OutsideIn);
+      nOutOfTime += classes.isFlag(i, muon::MuonTimeClasses::OutOfTime);
+      nNotRelativistic += classes.isFlag(i, muon::MuonTimeClasses::NotRelativistic);
+      nInTime += classes.isFlag(i, muon::MuonTimeClasses::Measured) &&
+	!(classes.flags[i] & (muon::MuonTimeClasses::OutsideIn | muon::MuonTimeClasses::OutOfTime));
+    }
+    CPPUNIT_ASSERT(summary.nMeasured == nMeasured);
+    CPPUNIT_ASSERT(summary.nOutsideIn == nOutsideIn);
+    CPPUNIT_ASSERT(summary.nOutOfTime == nOutOfTime);
+    CPPUNIT_ASSERT(summary.nNotRelativistic == nNotRelativistic);
+    CPPUNIT_ASSERT(summary.nInTime == nInTime);
+  }
+
+  bool sameSummary( const muon::MuonTimeEventSummary& a, const muon::MuonTimeEventSummary& b ) {
+    return a.nMuons == b.nMuons && a.nMeasured == b.nMeasured && a.nOutsideIn == b.nOutsideIn &&
+      a.nOutOfTime == b.nOutOfTime && a.nNotRelativistic == b.nNotRelativistic && a.nInTime == b.nInTime;
+  }
+}
+
+void testMuonTimeClassifier::checkCases()
+{
+  std::vector<reco::MuonTime> times;
+  // 0: not measured, with values which would otherwise set every flag
+  times.push_back(muonTime(1, 50, 3, 1, 2, 0.1));
+  // 1: prompt inside-out muon
+  times.push_back(muonTime(10, 1, 1, 2, 1.05, 0.05));
+  // 2: outside-in
+  times.push_back(muonTime(10, 1, 2, 1, 1, 0.05));
+  // 3: out of time, early and late
+  times.push_back(muonTime(10, -30, 1, 2, 1, 0.05));
+  times.push_back(muonTime(10, 30, 1, 2, 1, 0.05));
+  // 5: negative deviation, beyond the pull cut
+  times.push_back(muonTime(10, 1, 1, 2, 0.5, 0.1));
+  // 6: no error on 1/beta, with a positive and a negative deviation
+  times.push_back(muonTime(10, 1, 1, 2, 1.5, 0));
+  times.push_back(muonTime(10, 1, 1, 2, 0.5, 0));
+  // 8: no measurement at all
+  times.push_back(reco::MuonTime());
+
+  muon::MuonTimeClasses classes;
+  const muon::MuonTimeEventSummary summary = muon::classifyMuonTimes(&times[0], times.size(), classes);
+  check(times, classes, summary);
+
+  CPPUNIT_ASSERT(classes.direction[0] == reco::MuonTime::Undefined);
+  CPPUNIT_ASSERT(classes.flags[0] == 0 && classes.inverseBetaPull[0] == 0);
+  CPPUNIT_ASSERT(classes.direction[1] == reco::MuonTime::InsideOut);
+  CPPUNIT_ASSERT(classes.flags[1] == muon::MuonTimeClasses::Measured);
+  CPPUNIT_ASSERT(classes.direction[2] == reco::MuonTime::OutsideIn);
+  CPPUNIT_ASSERT(classes.isFlag(2, muon::MuonTimeClasses::Measured | muon::MuonTimeClasses::OutsideIn));
+  CPPUNIT_ASSERT(classes.isFlag(3, muon::MuonTimeClasses::OutOfTime));
+  CPPUNIT_ASSERT(classes.isFlag(4, muon::MuonTimeClasses::OutOfTime));
+  CPPUNIT_ASSERT(classes.inverseBetaPull[5] < -3);
+  CPPUNIT_ASSERT(classes.isFlag(5, muon::MuonTimeClasses::NotRelativistic));
+  for ( unsigned int i = 6; i < 8; ++i ) {
+    CPPUNIT_ASSERT(classes.inverseBetaPull[i] == 0 && !std::signbit(classes.inverseBetaPull[i]));
+    CPPUNIT_ASSERT(classes.flags[i] == muon::MuonTimeClasses::Measured);
+  }
+  CPPUNIT_ASSERT(classes.flags[8] == 0);
+
+  CPPUNIT_ASSERT(summary.nMuons == 9);
+  CPPUNIT_ASSERT(summary.nMeasured == 7);
+  CPPUNIT_ASSERT(summary.nOutsideIn == 1);
+  CPPUNIT_ASSERT(summary.nOutOfTime == 2);
+  CPPUNIT_ASSERT(summary.nNotRelativistic == 1);
+  CPPUNIT_ASSERT(summary.nInTime == 4);
+  CPPUNIT_ASSERT(!summary.noMuonInTime());
+
+  // the parameters are applied
+  muon::MuonTimeClassifierParameters parameters;
+  parameters.minNDof = 11;
+  parameters.maxTimeAtIp = 50;
+  parameters.maxInverseBetaPull = 0.5;
+  const muon::MuonTimeEventSummary none = muon::classifyMuonTimes(&times[0], times.size(), classes, parameters);
+  check(times, classes, none, parameters);
+  CPPUNIT_ASSERT(none.nMeasured == 0 && !none.noMuonInTime());
+  parameters.minNDof = 2;
+  check(times, classes, muon::classifyMuonTimes(&times[0], times.size(), classes, parameters), parameters);
+  CPPUNIT_ASSERT(classes.isFlag(1, muon::MuonTimeClasses::NotRelativistic));
+
+  // only cosmics and halo
+  std::vector<reco::MuonTime> outOfTime(times.begin()+2, times.begin()+5);
+  const muon::MuonTimeEventSummary rejected = muon::summarizeMuonTimes(&outOfTime[0], outOfTime.size());
+  CPPUNIT_ASSERT(rejected.nMeasured == 3 && rejected.nInTime == 0 && rejected.noMuonInTime());
+
+  // nothing at all
+  CPPUNIT_ASSERT(muon::classifyMuonTimes(0, 0, classes).nMuons == 0);
+  CPPUNIT_ASSERT(classes.size() == 0);
+}
+
+void testMuonTimeClassifier::checkDirection()
+{
+  // the encoded direction is the one of MuonTime with the default
+  // parameters, including equal errors and nDof at the threshold
+  const int nDofs[] = { 0, 1, 2, 3, 20 };
+  const float errors[] = { 0, 0.5, 1, 2 };
+  std::vector<reco::MuonTime> times;
+  for ( unsigned int n = 0; n < sizeof(nDofs)/sizeof(nDofs[0]); ++n )
+    for ( unsigned int i = 0; i < sizeof(errors)/sizeof(errors[0]); ++i )
+      for ( unsigned int o = 0; o < sizeof(errors)/sizeof(errors[0]); ++o )
+	times.push_back(muonTime(nDofs[n], 0, errors[i], errors[o], 1, 0.1));
+  muon::MuonTimeClasses classes;
+  check(times, classes, muon::classifyMuonTimes(&times[0], times.size(), classes));
+  for ( unsigned int i = 0; i < times.size(); ++i )
+    CPPUNIT_ASSERT(classes.direction[i] == times[i].direction());
+}
+
+void testMuonTimeClassifier::checkLargeCollection()
+{
+  // several blocks, the last one partly filled
+  std::vector<reco::MuonTime> times;
+  for ( unsigned int i = 0; i < 150; ++i )
+    times.push_back(muonTime(i%7, (i%11)*5.f - 25.f, 1 + i%3, 1 + i%5, 0.7f + 0.05f*(i%13), 0.05f*(i%4)));
+
+  muon::MuonTimeClasses classes;
+  const muon::MuonTimeEventSummary summary = muon::classifyMuonTimes(&times[0], times.size(), classes);
+  check(times, classes, summary);
+  CPPUNIT_ASSERT(summary.nMeasured > 0 && summary.nOutsideIn > 0 && summary.nOutOfTime > 0 &&
+		 summary.nNotRelativistic > 0 && summary.nInTime > 0);
+  CPPUNIT_ASSERT(sameSummary(summary, muon::summarizeMuonTimes(&times[0], times.size())));
+
+  // the summaries of parts add up
+  muon::MuonTimeEventSummary added = muon::summarizeMuonTimes(&times[0], 70);
+  added.add(muon::summarizeMuonTimes(&times[70], times.size()-70));
+  CPPUNIT_ASSERT(sameSummary(summary, added));
+}
+
+void testMuonTimeClassifier::checkInputs()
+{
+  std::vector<reco::MuonTime> times;
+  reco::MuonCollection muons(70);
+  std::vector<reco::MuonTimeExtra> extras(muons.size());
+  for ( unsigned int i = 0; i < muons.size(); ++i ) {
+    times.push_back(muonTime(i%4, (i%9)*6.f - 24.f, 1 + i%2, 1 + i%3, 0.8f + 0.1f*(i%5), 0.1f*(i%3)));
+    muons[i].setTime(times[i]);
+    reco::MuonTimeExtra& extra = extras[i];
+    extra.setNDof(times[i].nDof);
+    extra.setTimeAtIpInOut(times[i].timeAtIpInOut);
+    extra.setTimeAtIpInOutErr(times[i].timeAtIpInOutErr);
+    extra.setTimeAtIpOutIn(times[i].timeAtIpOutIn);
+    extra.setTimeAtIpOutInErr(times[i].timeAtIpOutInErr);
+    extra.setInverseBeta(times[i].inverseBeta());
+    extra.setInverseBetaErr(times[i].inverseBetaErr());
+  }
+  muon::MuonTimeClasses expected;
+  const muon::MuonTimeEventSummary summary = muon::classifyMuonTimes(&times[0], times.size(), expected);
+  check(times, expected, summary);
+
+  muon::MuonTimeClasses classes;
+  CPPUNIT_ASSERT(sameSummary(summary, muon::classifyMuonTimes(muons, classes)));
+  CPPUNIT_ASSERT(classes.direction == expected.direction && classes.flags == expected.flags &&
+		 classes.inverseBetaPull == expected.inverseBetaPull);
+  CPPUNIT_ASSERT(sameSummary(summary, muon::summarizeMuonTimes(muons)));
+
+  // the muons are the second collection of the map
+  reco::MuonCollection otherMuons(3);
+  edm::TestHandle<reco::MuonCollection> otherHandle(&otherMuons, edm::ProductID(1, 1));
+  edm::TestHandle<reco::MuonCollection> handle(&muons, edm::ProductID(1, 2));
+  std::vector<reco::MuonTimeExtra> otherExtras(otherMuons.size());
+  reco::MuonTimeExtraMap map;
+  reco::MuonTimeExtraMap::Filler filler(map);
+  filler.insert(otherHandle, otherExtras.begin(), otherExtras.end());
+  filler.insert(handle, extras.begin(), extras.end());
+  filler.fill();
+  const reco::MuonRefProd muonRefProd(handle);
+  CPPUNIT_ASSERT(sameSummary(summary, muon::classifyMuonTimes(map, muonRefProd, classes)));
+  CPPUNIT_ASSERT(classes.direction == expected.direction && classes.flags == expected.flags &&
+		 classes.inverseBetaPull == expected.inverseBetaPull);
+  CPPUNIT_ASSERT(sameSummary(summary, muon::summarizeMuonTimes(map, muonRefProd)));
+
+  // a collection the map does not know
+  reco::MuonCollection unknownMuons(1);
+  const reco::MuonRefProd unknown(edm::TestHandle<reco::MuonCollection>(&unknownMuons, edm::ProductID(1, 3)));
+  CPPUNIT_ASSERT_THROW(muon::classifyMuonTimes(map, unknown, classes), cms::Exception);
+  CPPUNIT_ASSERT_THROW(muon::summarizeMuonTimes(map, unknown), cms::Exception);
+}
@@ -0,0 +1,75 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonTimingFit.h"
+#include <cmath>
+
+class testMuonTimingFit : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonTimingFit);
+  CPPUNIT_TEST(checkMeans);
+  CPPUNIT_TEST(checkIdenticalMeasurements);
+  CPPUNIT_TEST(checkZeroDistance);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkMeans();
+  void checkIdenticalMeasurements();
+  void checkZeroDistance();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonTimingFit);
+
+namespace {
+  // cm/ns
+  const double speedOfLight = 29.9792458;
+}
+
+void testMuonTimingFit::checkMeans() {
+  // two t0 with the same error: the spread error, 4 ns, is above the
+  // 2/sqrt(2) ns from the errors alone
+  const double t0[2] = { 1., 9. };
+  const double distance[2] = { 400., 600. };
+  const double error[2] = { 2., 2. };
+  reco::MuonTime time = muon::fitMuonTime(t0, distance, error, 2);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(5., time.timeAtIpInOut, 1e-5);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(4., time.timeAtIpInOutErr, 1e-5);
+  const double outIn = (1. + 2.*400./speedOfLight + 9. + 2.*600./speedOfLight)/2.;
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(outIn, time.timeAtIpOutIn, 1e-5);
+  CPPUNIT_ASSERT_EQUAL(2, time.nDof);
+
+  // no measurement: the default result
+  reco::MuonTime none = muon::fitMuonTime(t0, distance, error, 0);
+  CPPUNIT_ASSERT_EQUAL(0, none.nDof);
+  CPPUNIT_ASSERT_EQUAL(0.f, none.timeAtIpInOut);
+}
+
+void testMuonTimingFit::checkIdenticalMeasurements() {
+  // no spread: the errors come from the t0 errors alone
+  const double t0[4] = { 3., 3., 3., 3. };
+  const double distance[4] = { 450., 500., 550., 700. };
+  const double error[4] = { 2., 2., 2., 2. };
+  reco::MuonTime time = muon::fitMuonTime(t0, distance, error, 4);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3., time.timeAtIpInOut, 1e-5);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1., time.timeAtIpInOutErr, 1e-5);
+  CPPUNIT_ASSERT(time.timeAtIpOutInErr >= 1.f - 1e-5f);
+  CPPUNIT_ASSERT(time.inverseBetaErr() > 0.f);
+}
+
+void testMuonTimingFit::checkZeroDistance() {
+  // a measurement at the interaction point does not enter inverseBeta
+  const double t0[2] = { 2., 4. };
+  const double distance[2] = { 0., 600. };
+  const double error[2] = { 3., 3. };
+  reco::MuonTime time = muon::fitMuonTime(t0, distance, error, 2);
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(1. + 4.*speedOfLight/600., time.inverseBeta(), 1e-3);
+  CPPUNIT_ASSERT(std::isfinite(time.inverseBetaErr()));
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3., time.timeAtIpInOut, 1e-5);
+  CPPUNIT_ASSERT(std::isfinite(time.freeInverseBeta()));
+
+  // with none away from it, inverseBeta keeps its default
+  const double atIP[2] = { 0., 0. };
+  reco::MuonTime none = muon::fitMuonTime(t0, atIP, error, 2);
+  CPPUNIT_ASSERT_EQUAL(0.f, none.inverseBeta());
+  CPPUNIT_ASSERT_EQUAL(0.f, none.inverseBetaErr());
+  CPPUNIT_ASSERT_DOUBLES_EQUAL(3., none.timeAtIpInOut, 1e-5);
+}
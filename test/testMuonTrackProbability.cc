@@ -0,0 +1,105 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/MuonTrackProbability.h"
+#include <cmath>
+
+class testMuonTrackProbability : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testMuonTrackProbability);
+  CPPUNIT_TEST(checkReferenceValues);
+  CPPUNIT_TEST(checkNearMedian);
+  CPPUNIT_TEST(checkBatch);
+  CPPUNIT_TEST(checkInvalidInput);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp() {}
+  void tearDown() {}
+  void checkReferenceValues();
+  void checkNearMedian();
+  void checkBatch();
+  void checkInvalidInput();
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testMuonTrackProbability);
+
+namespace {
+  const int nChi2 = 8;
+  const double chi2Values[nChi2] = { 1e-6, 0.5, 5, 30, 120, 600, 5000, 1e6 };
+
+  // -ln Q(ndof/2, chi2/2), evaluated with 50 digits (mpmath); the
+  // values below 1e-50 come out as 0 at that precision
+  struct Reference {
+    int ndof;
+    double value[nChi2];
+  };
+  const Reference references[] = {
+  {   1, { 0.00079820290701986939, 0.73501112983708439, 3.6750823266311889, 16.957318158128789, 62.627703688037883, 303.42591595890315, 2504.4845878484512, 500007.13354763162 } },
+  {   2, { 4.9999999999999998e-07, 0.25, 2.5, 15, 60, 300, 2500, 500000 } },
+  {   3, { 2.6596144051454768e-10, 0.084587322851899335, 1.7614408918243059, 13.493385732625001, 57.823813897301633, 297.02566400512569, 2495.9669948169021, 499993.31803507364 } },
+  {   7, { 7.5988976239475098e-24, 0.00055367185755362202, 0.41557115809808964, 9.2620577027666542, 50.923282444673283, 286.93317722267813, 2481.6398584753529, 499968.39506015886 } },
+  {  20, { 0, 2.0942485399975804e-13, 0.00027739056382620553, 2.6613527866436884, 35.79351359647913, 261.43743153134227, 2442.3818083360366, 499894.70053908334 } },
+  {  51, { 0, 4.4357515107150864e-42, 1.6164242705389302e-17, 0.0083806252576656953, 15.57061499056053, 216.5616223890502, 2364.6901960363962, 499734.89121589623 } },
+  {  99, { 0, 0, 1.0041937839052241e-45, 1.664219986687167e-12, 2.6004002548112948, 165.80825263670908, 2263.1314687081945, 499506.18256201252 } },
+  { 100, { 0, 0, 2.2386989250628002e-46, 9.0561255431522382e-13, 2.472108720635338, 164.90284332906424, 2261.1677029368507, 499501.56984044891 } },
+  { 101, { 0, 0, 4.9662641078223087e-47, 4.9041502076751219e-13, 2.3482036762100238, 164.0024805522329, 2259.2089875431375, 499496.96216930449 } },
+  { 150, { 0, 0, 0, 2.471513726062193e-28, 0.03466872631096056, 125.21119461283233, 2168.563474934047, 499276.5178761576 } },
+  { 400, { 0, 0, 0, 0, 6.7496959985642199e-46, 21.810610863624895, 1800.8656042939454, 498246.58295964397 } },
+  };
+  const unsigned int nReferences = sizeof(references)/sizeof(references[0]);
+
+  // around chi2 = ndof, where the terms of order ndof*ln(ndof) of the
+  // prefactor cancel
+  struct Point {
+    int ndof;
+    double chi2;
+    double value;
+  };
+  const Point medianPoints[] = {
+  {  50, 50.25, 0.76898363689037737 },
+  {  99, 100.98, 0.85381343001277532 },
+  { 150, 151, 0.77278524595665895 },
+  { 390, 391.95, 0.77062041982674053 },
+  { 399, 401, 0.77122604963067622 },
+  { 399, 421.35, 1.5523542524441267 },
+  };
+  const unsigned int nMedianPoints = sizeof(medianPoints)/sizeof(medianPoints[0]);
+
+  double tolerance(double expected) { return expected > 1. ? 1e-14*expected : 3e-14; }
+}
+
+void testMuonTrackProbability::checkReferenceValues() {
+  // relative precision 1e-14 where -ln P > 1, absolute 3e-14 elsewhere
+  for (unsigned int i = 0; i < nReferences; ++i)
+    for (int j = 0; j < nChi2; ++j) {
+      const double expected = references[i].value[j];
+      const double value = muon::chi2LogTailProbability(chi2Values[j], references[i].ndof);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected, value, tolerance(expected));
+    }
+}
+
+void testMuonTrackProbability::checkNearMedian() {
+  for (unsigned int i = 0; i < nMedianPoints; ++i) {
+    const Point& point = medianPoints[i];
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(point.value, muon::chi2LogTailProbability(point.chi2, point.ndof), tolerance(point.value));
+  }
+}
+
+void testMuonTrackProbability::checkBatch() {
+  double chi2[nReferences*nChi2];
+  int ndof[nReferences*nChi2];
+  double result[nReferences*nChi2];
+  for (unsigned int i = 0; i < nReferences; ++i)
+    for (int j = 0; j < nChi2; ++j) {
+      chi2[i*nChi2+j] = chi2Values[j];
+      ndof[i*nChi2+j] = references[i].ndof;
+    }
+  muon::chi2LogTailProbabilities(chi2, ndof, result, nReferences*nChi2);
+  for (unsigned int k = 0; k < nReferences*nChi2; ++k)
+    CPPUNIT_ASSERT_EQUAL(muon::chi2LogTailProbability(chi2[k], ndof[k]), result[k]);
+}
+
+void testMuonTrackProbability::checkInvalidInput() {
+  CPPUNIT_ASSERT_EQUAL(0., muon::chi2LogTailProbability(10., 0));
+  CPPUNIT_ASSERT_EQUAL(0., muon::chi2LogTailProbability(10., -3));
+  CPPUNIT_ASSERT_EQUAL(0., muon::chi2LogTailProbability(0., 5));
+  CPPUNIT_ASSERT_EQUAL(0., muon::chi2LogTailProbability(-1., 5));
+}
@@ -0,0 +1,155 @@
+#include <cppunit/extensions/HelperMacros.h>
+#include "DataFormats/MuonReco/interface/SlimCaloMuon.h"
+#include "DataFormats/TrackReco/interface/Track.h"
+#include "DataFormats/Common/interface/TestHandle.h"
+#include "FWCore/Utilities/interface/Exception.h"
+#include <vector>
+
+class testSlimCaloMuon : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(testSlimCaloMuon);
+  CPPUNIT_TEST(checkRoundTrip);
+  CPPUNIT_TEST(checkCollection);
+  CPPUNIT_TEST(checkTwoTrackCollections);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  void setUp();
+  void tearDown() {}
+  void checkRoundTrip();
+  void checkCollection();
+  void checkTwoTrackCollections();
+
+private:
+  reco::TrackCollection tracks_;
+  reco::TrackCollection otherTracks_;
+  reco::TrackRefProd trackProd_;
+  reco::TrackRefProd otherTrackProd_;
+  std::vector<reco::CaloMuon> muons_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(testSlimCaloMuon);
+
+namespace {
+  reco::CaloMuon caloMuon( const reco::TrackRef& track, float energy, float compatibility ) {
+    reco::CaloMuon muon;
+    if ( track.isNonnull() ) muon.setInnerTrack(track);
+    if ( energy > 0 ) {
+      reco::MuonEnergy calEnergy;
+      // values which are not exact half floats
+      calEnergy.em = energy;
+      calEnergy.emS9 = 1.1f*energy;
+      calEnergy.had = 2.3f*energy;
+      calEnergy.hadS9 = 2.9f*energy;
+      calEnergy.ho = 0.37f*energy;
+      calEnergy.hoS9 = 0.41f*energy;
+      muon.setCalEnergy(calEnergy);
+    }
+    muon.setCaloCompatibility(compatibility);
+    return muon;
+  }
+
+  void checkSame( const reco::SlimCaloMuon& expected, const reco::SlimCaloMuon& slim ) {
+    for ( int i = 0; i < reco::SlimCaloMuon::nEnergies; ++i )
+      CPPUNIT_ASSERT_EQUAL(expected.energy(reco::SlimCaloMuon::Energy(i)), slim.energy(reco::SlimCaloMuon::Energy(i)));
+    CPPUNIT_ASSERT_EQUAL(expected.isEnergyValid(), slim.isEnergyValid());
+    CPPUNIT_ASSERT_EQUAL(expected.isCaloCompatibilityValid(), slim.isCaloCompatibilityValid());
+    CPPUNIT_ASSERT_EQUAL(expected.caloCompatibility(), slim.caloCompatibility());
+    CPPUNIT_ASSERT_EQUAL(expected.hasTrack(), slim.hasTrack());
+    CPPUNIT_ASSERT_EQUAL(expected.trackKey(), slim.trackKey());
+  }
+}
+
+void testSlimCaloMuon::setUp()
+{
+  const reco::TrackBase::Point vertex(0, 0, 0);
+  for ( unsigned int i = 0; i < 3; ++i ) {
+    tracks_.push_back(reco::Track(1., 10., vertex, reco::TrackBase::Vector(1.+i, 0.5, -2.), 1, reco::TrackBase::CovarianceMatrix()));
+    otherTracks_.push_back(reco::Track(2., 12., vertex, reco::TrackBase::Vector(-1., 2.+i, 1.), -1, reco::TrackBase::CovarianceMatrix()));
+  }
+  trackProd_ = reco::TrackRefProd(edm::TestHandle<reco::TrackCollection>(&tracks_, edm::ProductID(1, 1)));
+  otherTrackProd_ = reco::TrackRefProd(edm::TestHandle<reco::TrackCollection>(&otherTracks_, edm::ProductID(1, 2)));
+
+  muons_.clear();
+  muons_.push_back(caloMuon(reco::TrackRef(trackProd_, 2), 1.234f, 0.3337f));
+  // no valid compatibility
+  muons_.push_back(caloMuon(reco::TrackRef(trackProd_, 0), 0.517f, -9999.f));
+  // a compatibility of exactly 1
+  muons_.push_back(caloMuon(reco::TrackRef(trackProd_, 1), 27.13f, 1.f));
+  // no track, and no energy
+  muons_.push_back(caloMuon(reco::TrackRef(), 0, 0.75f));
+}
+
+void testSlimCaloMuon::checkRoundTrip()
+{
+  for ( unsigned int i = 0; i < muons_.size(); ++i ) {
+    const reco::CaloMuon& muon = muons_[i];
+    const reco::SlimCaloMuon slim(muon);
+    const reco::CaloMuon back = slim.caloMuon(trackProd_);
+    checkSame(slim, reco::SlimCaloMuon(back));
+
+    // the rounded quantities stay close to the originals
+    CPPUNIT_ASSERT_EQUAL(muon.isEnergyValid(), back.isEnergyValid());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(muon.calEnergy().had, back.calEnergy().had, muon.calEnergy().had/2048.);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(muon.calEnergy().hoS9, back.calEnergy().hoS9, muon.calEnergy().hoS9/2048.);
+    CPPUNIT_ASSERT_EQUAL(muon.isCaloCompatibilityValid(), back.isCaloCompatibilityValid());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(muon.caloCompatibility(), back.caloCompatibility(), 1.6e-5);
+    CPPUNIT_ASSERT(muon.innerTrack() == back.innerTrack());
+  }
+
+  const reco::SlimCaloMuon invalid(muons_[1]);
+  CPPUNIT_ASSERT(!invalid.isCaloCompatibilityValid());
+  CPPUNIT_ASSERT_EQUAL(-9999.f, invalid.caloCompatibility());
+  CPPUNIT_ASSERT_EQUAL(-9999.f, invalid.caloMuon(trackProd_).caloCompatibility());
+
+  const reco::SlimCaloMuon one(muons_[2]);
+  CPPUNIT_ASSERT(one.isCaloCompatibilityValid());
+  CPPUNIT_ASSERT_EQUAL(1.f, one.caloCompatibility());
+
+  const reco::SlimCaloMuon noTrack(muons_[3]);
+  CPPUNIT_ASSERT(!noTrack.hasTrack());
+  CPPUNIT_ASSERT(!noTrack.isEnergyValid());
+  CPPUNIT_ASSERT(noTrack.caloMuon(trackProd_).innerTrack().isNull());
+  CPPUNIT_ASSERT_EQUAL(0.f, noTrack.em());
+
+  // the default is the slim form of a default CaloMuon
+  checkSame(reco::SlimCaloMuon(), reco::SlimCaloMuon(reco::CaloMuon()));
+}
+
+void testSlimCaloMuon::checkCollection()
+{
+  // the muon without a track does not decide the collection
+  std::vector<reco::CaloMuon> muons(muons_.rbegin(), muons_.rend());
+  const reco::SlimCaloMuons slims(muons);
+  CPPUNIT_ASSERT(slims.size() == muons.size());
+  CPPUNIT_ASSERT(slims.tracks().id() == trackProd_.id());
+
+  std::vector<reco::CaloMuon> back;
+  slims.fill(back);
+  CPPUNIT_ASSERT(back.size() == muons.size());
+  reco::SlimCaloMuons again(back);
+  for ( unsigned int i = 0; i < muons.size(); ++i ) {
+    checkSame(slims[i], again[i]);
+    CPPUNIT_ASSERT(slims.caloMuon(i).innerTrack() == muons[i].innerTrack());
+  }
+
+  reco::SlimCaloMuons swapped;
+  swapped.swap(again);
+  CPPUNIT_ASSERT(swapped.size() == muons.size() && again.empty());
+  CPPUNIT_ASSERT(swapped.tracks().id() == trackProd_.id() && again.tracks().isNull());
+}
+
+void testSlimCaloMuon::checkTwoTrackCollections()
+{
+  reco::SlimCaloMuons slims;
+  slims.push_back(muons_[3]);
+  slims.push_back(muons_[0]);
+  const reco::CaloMuon other = caloMuon(reco::TrackRef(otherTrackProd_, 0), 3.f, 0.5f);
+  CPPUNIT_ASSERT_THROW(slims.push_back(other), cms::Exception);
+  // the collection is left as it was
+  CPPUNIT_ASSERT(slims.size() == 2);
+  CPPUNIT_ASSERT(slims.tracks().id() == trackProd_.id());
+
+  std::vector<reco::CaloMuon> mixed(muons_);
+  mixed.push_back(other);
+  CPPUNIT_ASSERT_THROW(reco::SlimCaloMuons(mixed).size(), cms::Exception);
+}